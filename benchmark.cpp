@@ -0,0 +1,564 @@
+/*
+* headless benchmark: renders the scene offscreen for a fixed number of frames
+* and reports CPU frame-time percentiles and draw call counts.
+*
+* usage: 3D_Scene_Benchmark [--frames N] [--warmup N] [--width W] [--height H]
+*                           [--sort depth|state] [--prepass 0|1] [--occlusion off|queries|software]
+*                           [--textures array|separate] [--compression off|fast|high]
+*                           [--stream-budget KB] [--texture-budget MB]
+*                           [--filter none|nearest|linear] [--anisotropy N]
+*                           [--yaw DEGREES]
+*        3D_Scene_Benchmark --bvh MAX_OBJECTS
+*
+* --bvh skips rendering and times CPU frustum culling of random boxes, the linear SSE
+* batch test against the BVH, from 1k objects up to the given count in steps of 10x.
+*
+* fragment shader invocations are reported when the driver exposes
+* GL_ARB_pipeline_statistics_query (Mesa llvmpipe does).
+*
+* on Linux the context is an EGL pbuffer, so it runs on Mesa llvmpipe without a
+* display (falling back to the surfaceless platform when no X server is
+* available) and links against libEGL; the Makefile builds it there. on Windows it
+* uses a hidden GLFW window.
+*/
+
+//standard library
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// GLAD header
+#include <glad/glad.h>		// GLAD library
+
+#ifdef _WIN32
+#include <GLFW/glfw3.h>		// GLFW library
+#else
+#include <EGL/egl.h>		// EGL library
+#include <EGL/eglext.h>
+#endif
+
+// GLM headers
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// project headers
+#include <camera.h>
+#include <scene.h>
+#include <renderstats.h>
+#include <bvh.h>
+#include <frustum.h>
+#include <glextensions.h>
+
+// GL_ARB_pipeline_statistics_query, not part of the 3.3 core GLAD loader
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+#define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+#endif
+
+/*
+* user-defined functions to create and destroy the offscreen context
+*/
+bool initializeContext(int width, int height);
+void terminateContext();
+
+// unnamed namespace
+namespace
+{
+	// benchmark settings, overridable from the command line
+	int frames = 500;
+	int warmupFrames = 20;
+	int width = 800;
+	int height = 600;
+	RenderQueue::SortMode sortMode = RenderQueue::SORT_FRONT_TO_BACK;
+	bool depthPrepass = false;
+	Scene::OcclusionMode occlusionMode = Scene::OCCLUSION_QUERIES;
+	bool packTextures = true;		// one texture array instead of five 2D textures
+	TextureLoader::Compression compression = TextureLoader::COMPRESSION_HIGH;
+	int streamBudget = 4096;		// KB of mip levels uploaded per frame while loading, 0 for no limit
+	int textureBudget = 0;		// MB the textures may keep in GL, 0 for no limit
+	Sampler::MipFilter mipFilter = Sampler::MIP_LINEAR;
+	float anisotropy = 8.0f;		// for the table, 1 turns it off
+	float yaw = YAW;		// camera heading, turn it to push props out of view
+	unsigned int bvhObjects = 0;		// culling benchmark instead of rendering when set
+
+	// stops waiting for streamed textures after this many frames
+	const int MAX_LOADING_FRAMES = 100000;
+
+#ifdef _WIN32
+	GLFWwindow* window = nullptr;
+#else
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLSurface surface = EGL_NO_SURFACE;
+	EGLContext context = EGL_NO_CONTEXT;
+#endif
+
+	// milliseconds since the given time point
+	double millisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// times building, refitting and querying the BVH against the linear batch test.
+	// the boxes fill a cube around the camera at constant density, so the visible
+	// share stays about the same while the object count grows
+	void runCullingBenchmark(unsigned int maxObjects)
+	{
+		const glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
+		const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const Frustum frustum(projection * view);
+
+		std::mt19937 random(330);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> size(0.1f, 0.5f);
+
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << "   objects   build ms   refit ms  linear ms     bvh ms    visible" << std::endl;
+
+		for (unsigned int count = 1000; count <= maxObjects; count *= 10)
+		{
+			const float halfSize = 10.0f * std::cbrt((float)count / 1000.0f);
+			std::vector<Bounds> objects(count);
+			for (Bounds& object : objects)
+			{
+				object.center = glm::vec3(unit(random), unit(random), unit(random)) * halfSize;
+				object.extents = glm::vec3(size(random), size(random), size(random));
+				// the box's own corner sphere, so both tests see exactly the box
+				object.radius = glm::length(object.extents);
+			}
+
+			BVH bvh;
+			auto start = std::chrono::steady_clock::now();
+			bvh.build(objects);
+			const double buildTime = millisecondsSince(start);
+
+			// nudge every object, as an animation step would, and refit
+			for (Bounds& object : objects)
+				object.center += glm::vec3(unit(random), unit(random), unit(random)) * 0.05f;
+			start = std::chrono::steady_clock::now();
+			bvh.refit(objects);
+			const double refitTime = millisecondsSince(start);
+
+			BoundsArray array;
+			for (const Bounds& object : objects)
+				array.push(object);
+
+			// enough repetitions for a stable average at every size
+			const int repeats = (int)std::max(3u, 2000000u / count);
+			std::vector<unsigned char> visible(count);
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < repeats; i++)
+				frustum.testBatch(array, visible.data());
+			const double linearTime = millisecondsSince(start) / repeats;
+
+			std::vector<unsigned int> result;
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < repeats; i++)
+			{
+				result.clear();
+				bvh.queryFrustum(frustum, result);
+			}
+			const double bvhTime = millisecondsSince(start) / repeats;
+
+			// both must agree on what is visible
+			const size_t linearVisible = std::count(visible.begin(), visible.end(), 1);
+			std::cout << std::setw(10) << count << std::setw(11) << buildTime << std::setw(11) << refitTime
+				<< std::setw(11) << linearTime << std::setw(11) << bvhTime << std::setw(11) << result.size();
+			if (linearVisible != result.size())
+				std::cout << "  (linear " << linearVisible << ")";
+			std::cout << std::endl;
+		}
+	}
+
+	// returns the value at the given percentile of a sorted sample list
+	double percentile(const std::vector<double>& sorted, double p)
+	{
+		size_t index = (size_t)(p / 100.0 * (double)(sorted.size() - 1) + 0.5);
+		return sorted[std::min(index, sorted.size() - 1)];
+	}
+}
+
+
+/*
+* MAIN PROGRAM
+*/
+int main(int argc, char** argv)
+{
+	// parse command line
+	for (int i = 1; i < argc; i += 2)
+	{
+		// every flag takes a value
+		if (i + 1 == argc)
+		{
+			std::cout << "Missing value for " << argv[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (strcmp(argv[i], "--frames") == 0)
+			frames = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--warmup") == 0)
+			warmupFrames = std::max(0, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--width") == 0)
+			width = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--height") == 0)
+			height = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--sort") == 0 && strcmp(argv[i + 1], "depth") == 0)
+			sortMode = RenderQueue::SORT_FRONT_TO_BACK;
+		else if (strcmp(argv[i], "--sort") == 0 && strcmp(argv[i + 1], "state") == 0)
+			sortMode = RenderQueue::SORT_BY_STATE;
+		else if (strcmp(argv[i], "--prepass") == 0)
+			depthPrepass = atoi(argv[i + 1]) != 0;
+		else if (strcmp(argv[i], "--occlusion") == 0 && strcmp(argv[i + 1], "off") == 0)
+			occlusionMode = Scene::OCCLUSION_OFF;
+		else if (strcmp(argv[i], "--occlusion") == 0 && strcmp(argv[i + 1], "queries") == 0)
+			occlusionMode = Scene::OCCLUSION_QUERIES;
+		else if (strcmp(argv[i], "--occlusion") == 0 && strcmp(argv[i + 1], "software") == 0)
+			occlusionMode = Scene::OCCLUSION_SOFTWARE;
+		else if (strcmp(argv[i], "--textures") == 0 && strcmp(argv[i + 1], "array") == 0)
+			packTextures = true;
+		else if (strcmp(argv[i], "--textures") == 0 && strcmp(argv[i + 1], "separate") == 0)
+			packTextures = false;
+		else if (strcmp(argv[i], "--compression") == 0 && strcmp(argv[i + 1], "off") == 0)
+			compression = TextureLoader::COMPRESSION_OFF;
+		else if (strcmp(argv[i], "--compression") == 0 && strcmp(argv[i + 1], "fast") == 0)
+			compression = TextureLoader::COMPRESSION_FAST;
+		else if (strcmp(argv[i], "--compression") == 0 && strcmp(argv[i + 1], "high") == 0)
+			compression = TextureLoader::COMPRESSION_HIGH;
+		else if (strcmp(argv[i], "--stream-budget") == 0)
+			streamBudget = std::max(0, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--texture-budget") == 0)
+			textureBudget = std::max(0, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--filter") == 0 && strcmp(argv[i + 1], "none") == 0)
+			mipFilter = Sampler::MIP_NONE;
+		else if (strcmp(argv[i], "--filter") == 0 && strcmp(argv[i + 1], "nearest") == 0)
+			mipFilter = Sampler::MIP_NEAREST;
+		else if (strcmp(argv[i], "--filter") == 0 && strcmp(argv[i + 1], "linear") == 0)
+			mipFilter = Sampler::MIP_LINEAR;
+		else if (strcmp(argv[i], "--anisotropy") == 0)
+			anisotropy = std::max(1.0f, (float)atof(argv[i + 1]));
+		else if (strcmp(argv[i], "--yaw") == 0)
+			yaw = (float)atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--bvh") == 0)
+			bvhObjects = (unsigned int)std::max(1000, atoi(argv[i + 1]));
+		else
+		{
+			std::cout << "Unknown argument " << argv[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	// CPU only, no context needed
+	if (bvhObjects > 0)
+	{
+		runCullingBenchmark(bvhObjects);
+		return 0;
+	}
+
+	// try to create offscreen context
+	if (!initializeContext(width, height))
+	{
+		return EXIT_FAILURE;
+	}
+	glViewport(0, 0, width, height);
+
+	std::cout << "renderer:   " << glGetString(GL_RENDERER) << std::endl;
+	std::cout << "resolution: " << width << "x" << height << std::endl;
+	std::cout << "sort:       " << (sortMode == RenderQueue::SORT_FRONT_TO_BACK ? "front to back" : "by state")
+		<< (depthPrepass ? ", depth pre-pass" : "") << (occlusionMode == Scene::OCCLUSION_QUERIES ? ", occlusion queries" : "")
+		<< (occlusionMode == Scene::OCCLUSION_SOFTWARE ? ", software occlusion" : "") << std::endl;
+	std::cout << "textures:   " << (packTextures ? "texture array" : "separate 2D textures")
+		<< (compression == TextureLoader::COMPRESSION_OFF ? "" : ", block compressed")
+		<< (!packTextures && texStorage2D != NULL && textureBudget == 0 ? ", immutable storage" : "") << std::endl;
+	const char* filterNames[] = { "bilinear, no mips", "bilinear, nearest mip", "trilinear" };
+	std::cout << "filtering:  " << filterNames[mipFilter] << ", table anisotropy "
+		<< std::min(anisotropy, Sampler::maxAnisotropy()) << "x" << std::endl;
+
+
+	/*
+	* CREATE SCENE
+	*/
+	auto startup = std::chrono::steady_clock::now();
+	Scene scene(packTextures, compression);
+	scene.setSortMode(sortMode);
+	scene.setDepthPrepass(depthPrepass);
+	scene.setOcclusionMode(occlusionMode);
+	scene.setTextureStreamBudget((size_t)streamBudget * 1024);
+	scene.setTextureMemoryBudget((size_t)textureBudget * 1024 * 1024);
+	scene.setTextureFiltering(mipFilter, anisotropy);
+	Camera camera(glm::vec3(0.0f, 3.0f, 8.0f), glm::vec3(0.0f, 1.0f, 0.0f), yaw);		// same starting view as the interactive window
+	const float aspectRatio = (float)width / (float)height;
+
+	// time to first frame, textures may still show their placeholders
+	scene.render(camera, aspectRatio, height);
+	glFinish();
+	const double firstFrameTime = millisecondsSince(startup);
+
+	// keep rendering while the textures stream in, the longest of these frames
+	// is the hitch a player would see
+	int loadingFrames = 0;
+	double longestLoadingFrame = 0.0;
+	while (!scene.texturesLoaded() && loadingFrames < MAX_LOADING_FRAMES)
+	{
+		auto start = std::chrono::steady_clock::now();
+		scene.render(camera, aspectRatio, height);
+		glFinish();
+		longestLoadingFrame = std::max(longestLoadingFrame, millisecondsSince(start));
+		loadingFrames++;
+	}
+
+	// the timed frames below all see the final textures
+	scene.finishLoading();
+	glFinish();
+	const double texturesLoadedTime = millisecondsSince(startup);
+
+
+	/*
+	* RENDER LOOP
+	*/
+	std::vector<double> frameTimes;
+	frameTimes.reserve(frames);
+	unsigned long long totalDrawCalls = 0;
+	unsigned long long totalUniformUploads = 0;
+	unsigned long long totalUniformUploadsSkipped = 0;
+	unsigned long long totalUniformBufferUpdates = 0;
+	unsigned long long totalStateChanges = 0;
+	unsigned long long totalStateChangesFiltered = 0;
+	unsigned long long totalFragmentInvocations = 0;
+	unsigned long long totalObjectsTested = 0;
+	unsigned long long totalObjectsCulled = 0;
+	unsigned long long totalOcclusionQueries = 0;
+	unsigned long long totalObjectsOccluded = 0;
+
+	// counts fragment shader invocations across both passes of a frame
+	const bool pipelineStatistics = hasExtension("GL_ARB_pipeline_statistics_query");
+	unsigned int fragmentQuery = 0;
+	if (pipelineStatistics)
+		glGenQueries(1, &fragmentQuery);
+
+	for (int frame = 0; frame < warmupFrames + frames; frame++)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		renderStats.reset();
+		if (pipelineStatistics)
+			glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, fragmentQuery);
+		scene.render(camera, aspectRatio, height);
+		if (pipelineStatistics)
+			glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+
+		// wait for the frame so the timing covers the rasterizer as well
+		glFinish();
+
+		auto end = std::chrono::steady_clock::now();
+
+		if (frame >= warmupFrames)
+		{
+			frameTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			totalDrawCalls += renderStats.drawCalls;
+			totalUniformUploads += renderStats.uniformUploads;
+			totalUniformUploadsSkipped += renderStats.uniformUploadsSkipped;
+			totalUniformBufferUpdates += renderStats.uniformBufferUpdates;
+			totalStateChanges += renderStats.stateChanges;
+			totalStateChangesFiltered += renderStats.stateChangesFiltered;
+			totalObjectsTested += renderStats.objectsTested;
+			totalObjectsCulled += renderStats.objectsCulled;
+			totalOcclusionQueries += renderStats.occlusionQueries;
+			totalObjectsOccluded += renderStats.objectsOccluded;
+
+			if (pipelineStatistics)
+			{
+				// the frame has finished, the result is available without stalling
+				GLuint64 invocations = 0;
+				glGetQueryObjectui64v(fragmentQuery, GL_QUERY_RESULT, &invocations);
+				totalFragmentInvocations += invocations;
+			}
+		}
+	}
+
+
+	/*
+	* REPORT
+	*/
+	std::vector<double> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "startup:    first frame after " << firstFrameTime << " ms, textures loaded after "
+		<< texturesLoadedTime << " ms, " << (double)scene.textureMemory() / (1024.0 * 1024.0) << " MB of texture data" << std::endl;
+	std::cout << "streaming:  " << loadingFrames << " frames while loading, longest " << longestLoadingFrame << " ms" << std::endl;
+	std::cout << "loads:      image        decode ms  upload ms   drawn ms  complete ms         KB" << std::endl;
+	for (const TextureLoader::LoadStats& load : scene.textureLoadStats())
+	{
+		std::cout << "            " << std::left << std::setw(12) << load.path << std::right;
+		if (load.shared)
+		{
+			std::cout << "  shares the texture loaded for the same image" << std::endl;
+			continue;
+		}
+		std::cout << std::setw(10) << load.decodeTime << std::setw(11) << load.uploadTime
+			<< std::setw(11) << load.firstLevelsTime << std::setw(13) << load.completeTime
+			<< std::setw(11) << (double)load.bytes / 1024.0 << (load.cached ? "  cached" : "  decoded") << std::endl;
+	}
+	std::cout << "frames:     " << frames << " (+" << warmupFrames << " warmup)" << std::endl;
+	std::cout << "frame time (ms): p50 " << percentile(sorted, 50.0)
+		<< "  p95 " << percentile(sorted, 95.0)
+		<< "  p99 " << percentile(sorted, 99.0)
+		<< "  max " << sorted.back() << std::endl;
+	std::cout << "draw calls: " << totalDrawCalls << " total, "
+		<< (double)totalDrawCalls / (double)frames << " per frame" << std::endl;
+	std::cout << "uniforms:   " << (double)totalUniformUploads / (double)frames << " uploaded, "
+		<< (double)totalUniformUploadsSkipped / (double)frames << " unchanged, "
+		<< (double)totalUniformBufferUpdates / (double)frames << " block writes per frame" << std::endl;
+	std::cout << "gl state:   " << (double)totalStateChanges / (double)frames << " issued, "
+		<< (double)totalStateChangesFiltered / (double)frames << " filtered per frame" << std::endl;
+	std::cout << "culling:    " << (double)totalObjectsTested / (double)frames << " tested, "
+		<< (double)totalObjectsCulled / (double)frames << " outside the frustum per frame" << std::endl;
+	std::cout << "occlusion:  " << (double)totalOcclusionQueries / (double)frames << " queries, "
+		<< (double)totalObjectsOccluded / (double)frames << " objects occluded per frame" << std::endl;
+	if (pipelineStatistics)
+		std::cout << "fragments:  " << (double)totalFragmentInvocations / (double)frames
+			<< " shader invocations per frame (" << (double)totalFragmentInvocations / (double)frames / ((double)width * (double)height)
+			<< " per pixel)" << std::endl;
+	else
+		std::cout << "fragments:  GL_ARB_pipeline_statistics_query not supported" << std::endl;
+
+	if (pipelineStatistics)
+		glDeleteQueries(1, &fragmentQuery);
+
+	// destroy meshes, textures and shader program
+	scene.destroy();
+
+	terminateContext();
+	return 0;
+}
+
+
+#ifdef _WIN32
+
+/*
+creates a hidden GLFW window and loads GLAD
+*/
+bool initializeContext(int width, int height)
+{
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	window = glfwCreateWindow(width, height, "3D Scene Benchmark", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create window" << std::endl;
+		glfwTerminate();
+		return false;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSwapInterval(0);
+
+	// load OpenGL function pointers from GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return false;
+	}
+	// and what the context has beyond the 3.3 core
+	loadExtensions((GLADloadproc)glfwGetProcAddress);
+
+	return true;
+}
+
+void terminateContext()
+{
+	glfwTerminate();
+}
+
+#else
+
+/*
+creates an EGL pbuffer surface with an OpenGL 3.3 core context and loads GLAD
+*/
+bool initializeContext(int width, int height)
+{
+	display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+	{
+		// no window system, try Mesa's surfaceless platform instead
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		display = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL) : EGL_NO_DISPLAY;
+	}
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+	{
+		std::cout << "Failed to initialize EGL display" << std::endl;
+		return false;
+	}
+
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0)
+	{
+		std::cout << "Failed to find EGL pbuffer config" << std::endl;
+		return false;
+	}
+
+	const EGLint surfaceAttribs[] = {
+		EGL_WIDTH, width,
+		EGL_HEIGHT, height,
+		EGL_NONE
+	};
+	surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+	if (surface == EGL_NO_SURFACE)
+	{
+		std::cout << "Failed to create EGL pbuffer surface" << std::endl;
+		return false;
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+	const EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context))
+	{
+		std::cout << "Failed to create EGL context" << std::endl;
+		return false;
+	}
+
+	// load OpenGL function pointers from GLAD
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return false;
+	}
+	// and what the context has beyond the 3.3 core
+	loadExtensions((GLADloadproc)eglGetProcAddress);
+
+	return true;
+}
+
+void terminateContext()
+{
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(display, context);
+	eglDestroySurface(display, surface);
+	eglTerminate(display);
+}
+
+#endif
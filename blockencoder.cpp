@@ -0,0 +1,393 @@
+// STL
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// SSE intrinsics, every x64 target has them
+#if defined(_M_X64) || defined(__SSE__)
+#define BLOCKENCODER_SSE
+#include <xmmintrin.h>
+#endif
+
+// Project
+#include "blockencoder.h"
+
+// unnamed namespace
+namespace
+{
+	// fewest block rows worth a thread of their own
+	const int MIN_ROWS_PER_THREAD = 16;
+
+	// weight of colour 0 for each BC1 index, colour 1 gets the rest
+	const float INDEX_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	// runs encodeRows(firstRow, lastRow) over bands of the block rows on numThreads threads
+	template <typename Function>
+	void forEachBand(int numRows, unsigned int numThreads, Function encodeRows)
+	{
+		if (numThreads == 0)
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+		numThreads = std::min(numThreads, (unsigned int)std::max(1, numRows / MIN_ROWS_PER_THREAD));
+
+		if (numThreads <= 1)
+		{
+			encodeRows(0, numRows);
+			return;
+		}
+
+		// the calling thread takes the last band
+		std::vector<std::thread> threads;
+		const int rowsPerThread = (numRows + (int)numThreads - 1) / (int)numThreads;
+		for (unsigned int i = 0; i + 1 < numThreads; i++)
+		{
+			const int firstRow = (int)i * rowsPerThread;
+			threads.push_back(std::thread(encodeRows, firstRow, std::min(numRows, firstRow + rowsPerThread)));
+		}
+		encodeRows(std::min(numRows, (int)(numThreads - 1) * rowsPerThread), numRows);
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	float clampChannel(float value)
+	{
+		return std::min(255.0f, std::max(0.0f, value));
+	}
+
+	// colour with 5, 6 and 5 bits, rounded to nearest
+	unsigned int packRGB565(const float* color)
+	{
+		const unsigned int red = (unsigned int)(clampChannel(color[0]) * 31.0f / 255.0f + 0.5f);
+		const unsigned int green = (unsigned int)(clampChannel(color[1]) * 63.0f / 255.0f + 0.5f);
+		const unsigned int blue = (unsigned int)(clampChannel(color[2]) * 31.0f / 255.0f + 0.5f);
+		return (red << 11) | (green << 5) | blue;
+	}
+
+	// the 8 bit colour a decoder expands a 565 colour to
+	void unpackRGB565(unsigned int packed, float* color)
+	{
+		const unsigned int red = (packed >> 11) & 31;
+		const unsigned int green = (packed >> 5) & 63;
+		const unsigned int blue = packed & 31;
+		color[0] = (float)((red << 3) | (red >> 2));
+		color[1] = (float)((green << 2) | (green >> 4));
+		color[2] = (float)((blue << 3) | (blue >> 2));
+	}
+
+	/*
+	* picks the nearest of the four BC1 colours between endpoints 0 and 1 for each
+	* pixel, returns the summed squared error
+	*/
+	float selectIndices(const float* red, const float* green, const float* blue,
+		unsigned int packed0, unsigned int packed1, unsigned char* indices)
+	{
+		float endpoint0[3], endpoint1[3];
+		unpackRGB565(packed0, endpoint0);
+		unpackRGB565(packed1, endpoint1);
+
+		float palette[4][3];
+		for (int i = 0; i < 4; i++)
+		{
+			for (int channel = 0; channel < 3; channel++)
+				palette[i][channel] = INDEX_WEIGHTS[i] * endpoint0[channel] + (1.0f - INDEX_WEIGHTS[i]) * endpoint1[channel];
+		}
+
+#ifdef BLOCKENCODER_SSE
+		__m128 error = _mm_setzero_ps();
+		for (int pixel = 0; pixel < 16; pixel += 4)
+		{
+			const __m128 r = _mm_loadu_ps(red + pixel);
+			const __m128 g = _mm_loadu_ps(green + pixel);
+			const __m128 b = _mm_loadu_ps(blue + pixel);
+
+			__m128 best = _mm_set1_ps(1e30f);
+			__m128 bestIndex = _mm_setzero_ps();
+			for (int i = 0; i < 4; i++)
+			{
+				const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[i][0]));
+				const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(palette[i][1]));
+				const __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[i][2]));
+				const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+
+				const __m128 closer = _mm_cmplt_ps(distance, best);
+				best = _mm_min_ps(distance, best);
+				bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((float)i)), _mm_andnot_ps(closer, bestIndex));
+			}
+			error = _mm_add_ps(error, best);
+
+			float lanes[4];
+			_mm_storeu_ps(lanes, bestIndex);
+			for (int lane = 0; lane < 4; lane++)
+				indices[pixel + lane] = (unsigned char)lanes[lane];
+		}
+
+		float sums[4];
+		_mm_storeu_ps(sums, error);
+		return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+		float error = 0.0f;
+		for (int pixel = 0; pixel < 16; pixel++)
+		{
+			float best = 1e30f;
+			for (int i = 0; i < 4; i++)
+			{
+				const float dr = red[pixel] - palette[i][0];
+				const float dg = green[pixel] - palette[i][1];
+				const float db = blue[pixel] - palette[i][2];
+				const float distance = dr * dr + dg * dg + db * db;
+				if (distance < best)
+				{
+					best = distance;
+					indices[pixel] = (unsigned char)i;
+				}
+			}
+			error += best;
+		}
+		return error;
+#endif
+	}
+}
+
+size_t BlockEncoder::encodedSize(int width, int height)
+{
+	return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * 8;
+}
+
+void BlockEncoder::encodeBC1(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+	Quality quality, unsigned int numThreads)
+{
+	forEachBand((height + 3) / 4, numThreads, [=](int firstRow, int lastRow)
+	{
+		encodeBC1Rows(pixels, width, height, blocks, quality, firstRow, lastRow);
+	});
+}
+
+void BlockEncoder::encodeRGTC1(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+	unsigned int numThreads)
+{
+	forEachBand((height + 3) / 4, numThreads, [=](int firstRow, int lastRow)
+	{
+		encodeRGTC1Rows(pixels, width, height, blocks, firstRow, lastRow);
+	});
+}
+
+void BlockEncoder::encodeBC1Rows(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+	Quality quality, int firstRow, int lastRow)
+{
+	const int blocksX = (width + 3) / 4;
+	float red[16], green[16], blue[16];
+
+	for (int blockY = firstRow; blockY < lastRow; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksX; blockX++)
+		{
+			for (int pixel = 0; pixel < 16; pixel++)
+			{
+				const int x = std::min(blockX * 4 + pixel % 4, width - 1);
+				const int y = std::min(blockY * 4 + pixel / 4, height - 1);
+				const unsigned char* source = &pixels[((size_t)y * width + x) * 3];
+				red[pixel] = source[0];
+				green[pixel] = source[1];
+				blue[pixel] = source[2];
+			}
+			encodeBC1Block(red, green, blue, quality, &blocks[((size_t)blockY * blocksX + blockX) * 8]);
+		}
+	}
+}
+
+void BlockEncoder::encodeRGTC1Rows(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+	int firstRow, int lastRow)
+{
+	const int blocksX = (width + 3) / 4;
+	unsigned char values[16];
+
+	for (int blockY = firstRow; blockY < lastRow; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksX; blockX++)
+		{
+			for (int pixel = 0; pixel < 16; pixel++)
+			{
+				const int x = std::min(blockX * 4 + pixel % 4, width - 1);
+				const int y = std::min(blockY * 4 + pixel / 4, height - 1);
+				values[pixel] = pixels[(size_t)y * width + x];
+			}
+			encodeRGTC1Block(values, &blocks[((size_t)blockY * blocksX + blockX) * 8]);
+		}
+	}
+}
+
+void BlockEncoder::encodeBC1Block(const float* red, const float* green, const float* blue, Quality quality, unsigned char* block)
+{
+	const float* channels[3] = { red, green, blue };
+
+	// mean and covariance of the pixels
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		for (int channel = 0; channel < 3; channel++)
+			mean[channel] += channels[channel][pixel] / 16.0f;
+	}
+
+	float covariance[3][3] = {};
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		const float offset[3] = { red[pixel] - mean[0], green[pixel] - mean[1], blue[pixel] - mean[2] };
+		for (int row = 0; row < 3; row++)
+		{
+			for (int column = 0; column < 3; column++)
+				covariance[row][column] += offset[row] * offset[column];
+		}
+	}
+
+	// principal axis by power iteration, from the column of the widest channel
+	int widest = 0;
+	for (int channel = 1; channel < 3; channel++)
+	{
+		if (covariance[channel][channel] > covariance[widest][widest])
+			widest = channel;
+	}
+	float axis[3] = { covariance[0][widest], covariance[1][widest], covariance[2][widest] };
+	for (int iteration = 0; iteration < 4; iteration++)
+	{
+		float next[3];
+		for (int row = 0; row < 3; row++)
+			next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+
+		const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+		if (length < 1e-6f)
+			break;
+		for (int row = 0; row < 3; row++)
+			axis[row] = next[row] / length;
+	}
+	const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+
+	// endpoints at the extremes along the axis, or the mean for a flat block
+	float endpoint0[3] = { mean[0], mean[1], mean[2] };
+	float endpoint1[3] = { mean[0], mean[1], mean[2] };
+	if (axisLength > 1e-6f)
+	{
+		float minProjection = 1e30f, maxProjection = -1e30f;
+		for (int pixel = 0; pixel < 16; pixel++)
+		{
+			const float projection = ((red[pixel] - mean[0]) * axis[0] + (green[pixel] - mean[1]) * axis[1] +
+				(blue[pixel] - mean[2]) * axis[2]) / axisLength;
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+		for (int channel = 0; channel < 3; channel++)
+		{
+			endpoint0[channel] = mean[channel] + axis[channel] / axisLength * maxProjection;
+			endpoint1[channel] = mean[channel] + axis[channel] / axisLength * minProjection;
+		}
+	}
+
+	unsigned int packed0 = packRGB565(endpoint0);
+	unsigned int packed1 = packRGB565(endpoint1);
+	unsigned char indices[16];
+	float error = selectIndices(red, green, blue, packed0, packed1, indices);
+
+	// least squares endpoints for the chosen indices, kept while they lower the error
+	for (int iteration = 0; quality == QUALITY_HIGH && iteration < 2; iteration++)
+	{
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+		for (int pixel = 0; pixel < 16; pixel++)
+		{
+			const float a = INDEX_WEIGHTS[indices[pixel]];
+			const float b = 1.0f - a;
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+			for (int channel = 0; channel < 3; channel++)
+			{
+				ax[channel] += a * channels[channel][pixel];
+				bx[channel] += b * channels[channel][pixel];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f)
+			break;
+
+		float refined0[3], refined1[3];
+		for (int channel = 0; channel < 3; channel++)
+		{
+			refined0[channel] = (ax[channel] * bb - bx[channel] * ab) / determinant;
+			refined1[channel] = (bx[channel] * aa - ax[channel] * ab) / determinant;
+		}
+
+		const unsigned int refinedPacked0 = packRGB565(refined0);
+		const unsigned int refinedPacked1 = packRGB565(refined1);
+		unsigned char refinedIndices[16];
+		const float refinedError = selectIndices(red, green, blue, refinedPacked0, refinedPacked1, refinedIndices);
+		if (refinedError >= error)
+			break;
+
+		packed0 = refinedPacked0;
+		packed1 = refinedPacked1;
+		error = refinedError;
+		std::copy(refinedIndices, refinedIndices + 16, indices);
+	}
+
+	// four colour mode needs colour 0 above colour 1. swapping them swaps the
+	// indices 0/1 and 2/3; equal colours decode index 0 the same in either mode
+	unsigned int flip = 0;
+	if (packed0 < packed1)
+	{
+		std::swap(packed0, packed1);
+		flip = 1;
+	}
+	else if (packed0 == packed1)
+	{
+		std::fill(indices, indices + 16, (unsigned char)0);
+	}
+
+	unsigned int bits = 0;
+	for (int pixel = 0; pixel < 16; pixel++)
+		bits |= (unsigned int)(indices[pixel] ^ flip) << (pixel * 2);
+
+	block[0] = (unsigned char)(packed0 & 0xFF);
+	block[1] = (unsigned char)(packed0 >> 8);
+	block[2] = (unsigned char)(packed1 & 0xFF);
+	block[3] = (unsigned char)(packed1 >> 8);
+	block[4] = (unsigned char)(bits & 0xFF);
+	block[5] = (unsigned char)((bits >> 8) & 0xFF);
+	block[6] = (unsigned char)((bits >> 16) & 0xFF);
+	block[7] = (unsigned char)(bits >> 24);
+}
+
+void BlockEncoder::encodeRGTC1Block(const unsigned char* values, unsigned char* block)
+{
+	const unsigned char maxValue = *std::max_element(values, values + 16);
+	const unsigned char minValue = *std::min_element(values, values + 16);
+
+	// eight value mode: the endpoints and six steps between them
+	float palette[8];
+	palette[0] = maxValue;
+	palette[1] = minValue;
+	for (int i = 2; i < 8; i++)
+		palette[i] = ((8 - i) * maxValue + (i - 1) * minValue) / 7.0f;
+
+	unsigned long long bits = 0;
+	for (int pixel = 0; maxValue != minValue && pixel < 16; pixel++)
+	{
+		int bestIndex = 0;
+		float best = 1e30f;
+		for (int i = 0; i < 8; i++)
+		{
+			const float distance = std::fabs(values[pixel] - palette[i]);
+			if (distance < best)
+			{
+				best = distance;
+				bestIndex = i;
+			}
+		}
+		bits |= (unsigned long long)bestIndex << (pixel * 3);
+	}
+
+	block[0] = maxValue;
+	block[1] = minValue;
+	for (int i = 0; i < 6; i++)
+		block[2 + i] = (unsigned char)((bits >> (i * 8)) & 0xFF);
+}
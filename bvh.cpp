@@ -0,0 +1,372 @@
+// STL
+#include <algorithm>
+#include <cfloat>
+
+// Project
+#include "bvh.h"
+
+// unnamed namespace
+namespace
+{
+	// half the surface area of a box, enough to compare SAH costs
+	float halfArea(const glm::vec3& min, const glm::vec3& max)
+	{
+		const glm::vec3 size = max - min;
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	struct Bin
+	{
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+		unsigned int count = 0;
+	};
+}
+
+void BVH::build(const std::vector<Bounds>& objects)
+{
+	const unsigned int count = (unsigned int)objects.size();
+
+	boxes.resize(count);
+	indices.resize(count);
+	Node root;
+	root.min = glm::vec3(FLT_MAX);
+	root.max = glm::vec3(-FLT_MAX);
+	glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		boxes[i].min = objects[i].center - objects[i].extents;
+		boxes[i].max = objects[i].center + objects[i].extents;
+		indices[i] = i;
+
+		root.min = glm::min(root.min, boxes[i].min);
+		root.max = glm::max(root.max, boxes[i].max);
+		centroidMin = glm::min(centroidMin, objects[i].center);
+		centroidMax = glm::max(centroidMax, objects[i].center);
+	}
+
+	// a binary tree with at most one object per leaf has 2n - 1 nodes, reserving that
+	// keeps node references valid while the tree grows
+	nodes.clear();
+	if (count == 0)
+		return;
+	nodes.reserve(count * 2);
+
+	root.left = 0;
+	root.first = 0;
+	root.count = count;
+	nodes.push_back(root);
+	subdivide(0, centroidMin, centroidMax);
+}
+
+void BVH::refit(const std::vector<Bounds>& objects)
+{
+	for (unsigned int i = 0; i < (unsigned int)objects.size(); i++)
+	{
+		boxes[i].min = objects[i].center - objects[i].extents;
+		boxes[i].max = objects[i].center + objects[i].extents;
+	}
+
+	// children are always stored after their parent, so walking backwards visits
+	// both children before the node that encloses them
+	for (unsigned int i = (unsigned int)nodes.size(); i-- > 0;)
+	{
+		Node& node = nodes[i];
+		if (node.left == 0)
+		{
+			growToObjects(node);
+		}
+		else
+		{
+			const Node& left = nodes[node.left];
+			const Node& right = nodes[node.left + 1];
+			node.min = glm::min(left.min, right.min);
+			node.max = glm::max(left.max, right.max);
+		}
+	}
+}
+
+void BVH::subdivide(unsigned int nodeIndex, const glm::vec3& centroidMin, const glm::vec3& centroidMax)
+{
+	Node& node = nodes[nodeIndex];
+	if (node.count <= MAX_LEAF_SIZE)
+		return;
+
+	// bins are laid over the centroids, not the boxes. all three axes are binned in
+	// the same pass so every object is fetched once per level
+	Bin bins[3][NUM_BINS];
+	glm::vec3 scale;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const float extent = centroidMax[axis] - centroidMin[axis];
+		scale[axis] = extent > 0.0f ? (float)NUM_BINS / extent : 0.0f;
+	}
+
+	for (unsigned int i = node.first; i < node.first + node.count; i++)
+	{
+		const Box& box = boxes[indices[i]];
+		const glm::vec3 centroid = (box.min + box.max) * 0.5f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			Bin& bin = bins[axis][std::min(NUM_BINS - 1, (int)((centroid[axis] - centroidMin[axis]) * scale[axis]))];
+			bin.min = glm::min(bin.min, box.min);
+			bin.max = glm::max(bin.max, box.max);
+			bin.count++;
+		}
+	}
+
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = FLT_MAX;
+	Bin bestLeft, bestRight;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (scale[axis] == 0.0f)
+			continue;
+
+		// sweep from the left, then from the right, so every split plane is evaluated
+		// in one pass each. split s puts bins 0..s on the left
+		Bin left[NUM_BINS - 1];
+		Bin sweep;
+		for (int split = 0; split < NUM_BINS - 1; split++)
+		{
+			sweep.min = glm::min(sweep.min, bins[axis][split].min);
+			sweep.max = glm::max(sweep.max, bins[axis][split].max);
+			sweep.count += bins[axis][split].count;
+			left[split] = sweep;
+		}
+
+		sweep = Bin();
+		for (int split = NUM_BINS - 2; split >= 0; split--)
+		{
+			sweep.min = glm::min(sweep.min, bins[axis][split + 1].min);
+			sweep.max = glm::max(sweep.max, bins[axis][split + 1].max);
+			sweep.count += bins[axis][split + 1].count;
+			if (left[split].count == 0 || sweep.count == 0)
+				continue;
+
+			const float cost = halfArea(left[split].min, left[split].max) * left[split].count + halfArea(sweep.min, sweep.max) * sweep.count;
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+				bestLeft = left[split];
+				bestRight = sweep;
+			}
+		}
+	}
+
+	// every centroid in the same spot, or testing the objects directly is cheaper
+	// than one more level of boxes
+	const float nodeArea = halfArea(node.min, node.max);
+	if (bestAxis < 0 || nodeArea + bestCost >= nodeArea * node.count)
+		return;
+
+	// partition the range in place around the chosen plane, collecting the
+	// centroid boxes of both sides on the way
+	glm::vec3 leftCentroidMin(FLT_MAX), leftCentroidMax(-FLT_MAX);
+	glm::vec3 rightCentroidMin(FLT_MAX), rightCentroidMax(-FLT_MAX);
+	unsigned int i = node.first;
+	unsigned int j = node.first + node.count;
+	while (i < j)
+	{
+		const Box& box = boxes[indices[i]];
+		const glm::vec3 centroid = (box.min + box.max) * 0.5f;
+		const int bin = std::min(NUM_BINS - 1, (int)((centroid[bestAxis] - centroidMin[bestAxis]) * scale[bestAxis]));
+		if (bin <= bestSplit)
+		{
+			leftCentroidMin = glm::min(leftCentroidMin, centroid);
+			leftCentroidMax = glm::max(leftCentroidMax, centroid);
+			i++;
+		}
+		else
+		{
+			rightCentroidMin = glm::min(rightCentroidMin, centroid);
+			rightCentroidMax = glm::max(rightCentroidMax, centroid);
+			std::swap(indices[i], indices[--j]);
+		}
+	}
+
+	// child boxes are the unions of their bins
+	Node left;
+	left.min = bestLeft.min;
+	left.max = bestLeft.max;
+	left.left = 0;
+	left.first = node.first;
+	left.count = i - node.first;
+
+	Node right;
+	right.min = bestRight.min;
+	right.max = bestRight.max;
+	right.left = 0;
+	right.first = i;
+	right.count = node.count - left.count;
+
+	node.left = (unsigned int)nodes.size();
+	nodes.push_back(left);
+	nodes.push_back(right);
+
+	const unsigned int leftIndex = node.left;
+	subdivide(leftIndex, leftCentroidMin, leftCentroidMax);
+	subdivide(leftIndex + 1, rightCentroidMin, rightCentroidMax);
+}
+
+void BVH::growToObjects(Node& node) const
+{
+	node.min = glm::vec3(FLT_MAX);
+	node.max = glm::vec3(-FLT_MAX);
+	for (unsigned int i = node.first; i < node.first + node.count; i++)
+	{
+		node.min = glm::min(node.min, boxes[indices[i]].min);
+		node.max = glm::max(node.max, boxes[indices[i]].max);
+	}
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<unsigned int>& result) const
+{
+	if (nodes.empty())
+		return;
+
+	stack.clear();
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		const Frustum::Containment containment = frustum.classify((node.min + node.max) * 0.5f, (node.max - node.min) * 0.5f);
+		if (containment == Frustum::OUTSIDE)
+			continue;
+
+		// the whole subtree is visible, take its range without testing any further
+		if (containment == Frustum::INSIDE)
+		{
+			result.insert(result.end(), indices.begin() + node.first, indices.begin() + node.first + node.count);
+			continue;
+		}
+
+		if (node.left != 0)
+		{
+			stack.push_back(node.left);
+			stack.push_back(node.left + 1);
+			continue;
+		}
+
+		for (unsigned int i = node.first; i < node.first + node.count; i++)
+		{
+			const unsigned int object = indices[i];
+			if (frustum.classify((boxes[object].min + boxes[object].max) * 0.5f, (boxes[object].max - boxes[object].min) * 0.5f) != Frustum::OUTSIDE)
+				result.push_back(object);
+		}
+	}
+}
+
+void BVH::querySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& result) const
+{
+	if (nodes.empty())
+		return;
+
+	// squared distance from the sphere center to the closest point of a box
+	auto distanceSquared = [&center](const glm::vec3& min, const glm::vec3& max)
+	{
+		const glm::vec3 closest = glm::clamp(center, min, max);
+		return glm::dot(closest - center, closest - center);
+	};
+	const float radiusSquared = radius * radius;
+
+	stack.clear();
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (distanceSquared(node.min, node.max) > radiusSquared)
+			continue;
+
+		if (node.left != 0)
+		{
+			stack.push_back(node.left);
+			stack.push_back(node.left + 1);
+			continue;
+		}
+
+		for (unsigned int i = node.first; i < node.first + node.count; i++)
+		{
+			const unsigned int object = indices[i];
+			if (distanceSquared(boxes[object].min, boxes[object].max) <= radiusSquared)
+				result.push_back(object);
+		}
+	}
+}
+
+int BVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const
+{
+	if (nodes.empty())
+		return -1;
+
+	const glm::vec3 inverseDirection = 1.0f / direction;
+	int nearest = -1;
+	distance = maxDistance;
+
+	stack.clear();
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		// boxes entered beyond the nearest hit so far cannot hold a nearer one
+		if (intersect(node.min, node.max, origin, inverseDirection, distance) < 0.0f)
+			continue;
+
+		if (node.left != 0)
+		{
+			// visit the nearer child first so the hit distance shrinks sooner
+			const Node& left = nodes[node.left];
+			const Node& right = nodes[node.left + 1];
+			const float leftDistance = intersect(left.min, left.max, origin, inverseDirection, distance);
+			const float rightDistance = intersect(right.min, right.max, origin, inverseDirection, distance);
+			if (leftDistance >= 0.0f && rightDistance >= 0.0f && rightDistance < leftDistance)
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.left + 1);
+			}
+			else
+			{
+				if (rightDistance >= 0.0f)
+					stack.push_back(node.left + 1);
+				if (leftDistance >= 0.0f)
+					stack.push_back(node.left);
+			}
+			continue;
+		}
+
+		for (unsigned int i = node.first; i < node.first + node.count; i++)
+		{
+			const unsigned int object = indices[i];
+			const float hit = intersect(boxes[object].min, boxes[object].max, origin, inverseDirection, distance);
+			if (hit >= 0.0f && (nearest < 0 || hit < distance))
+			{
+				nearest = (int)object;
+				distance = hit;
+			}
+		}
+	}
+
+	return nearest;
+}
+
+float BVH::intersect(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+{
+	// slab test, the ray is inside the box between the last entry and the first exit
+	const glm::vec3 t1 = (min - origin) * inverseDirection;
+	const glm::vec3 t2 = (max - origin) * inverseDirection;
+	const glm::vec3 entries = glm::min(t1, t2);
+	const glm::vec3 exits = glm::max(t1, t2);
+
+	const float entry = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+	const float exit = std::min(std::min(exits.x, exits.y), std::min(exits.z, maxDistance));
+	return entry <= exit ? entry : -1.0f;
+}
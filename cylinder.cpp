@@ -1,6 +1,6 @@
 // STL
-#include <iostream>
-#include <string>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 // GLAD header
@@ -8,178 +8,179 @@
 
 // Project
 #include "cylinder.h"
-
-using namespace std;
+#include "renderstats.h"
+#include "glstate.h"
+#include "unitcircle.h"
 
 Cylinder::Cylinder(float topRadius, float bottomRadius, int numSlices, float height, bool topCircle, bool bottomCirlce)
+	: topRadius(topRadius), bottomRadius(bottomRadius), height(height)
 {
 
 	this->hasTop = topCircle;
 	this->hasBottom = bottomCirlce;
 
-	// calculate number of vertices
+	// with a cap missing the inside is visible, so back faces have to be drawn
+	this->doubleSided = !(hasTop && hasBottom);
+
+	// bounds around the wider of the two circles
+	const float maxRadius = std::max(topRadius, bottomRadius);
+	localBounds.extents = glm::vec3(maxRadius, height / 2.0f, maxRadius);
+	localBounds.radius = std::sqrt(maxRadius * maxRadius + height * height / 4.0f);
+
+	// calculate number of vertices and indices up front so nothing has to grow
+	const int numCircles = (hasTop ? 1 : 0) + (hasBottom ? 1 : 0);
 	numVerticesSide = (numSlices + 1) * 2;
 	numVerticesTopBottom = numSlices + 2;
-	numVerticesTotal = numVerticesSide + numVerticesTopBottom * 2;
+	numVerticesTotal = numVerticesSide + numVerticesTopBottom * numCircles;
+	numIndices = numSlices * 6 + numSlices * 3 * numCircles;
 
-	// calculate sines/cosines for number of slices
-	const auto sliceAngleStep = 2.0f * glm::pi<float>() / float(numSlices);
-	auto currentSliceAngle = 0.0f;
-	std::vector<float> sines, cosines;
-	for (auto i = 0; i <= numSlices; i++)
-	{
-		sines.push_back(sin(currentSliceAngle));
-		cosines.push_back(cos(currentSliceAngle));
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
 
-		// update slice angle
-		currentSliceAngle += sliceAngleStep;
-	}
+	glState.bindVertexArray(VAO);
 
-	// calculate X and Z coordinates for top and bottom circles
-	std::vector<float> xTop, xBottom;
-	std::vector<float> zTop, zBottom;
-	for (auto i = 0; i <= numSlices; i++)
+	// allocate both buffers and map them so vertices are written straight into GL memory
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, numVerticesTotal * sizeof(Vertex), NULL, GL_STATIC_DRAW);
+	Vertex* vertices = (Vertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, numVerticesTotal * sizeof(Vertex), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+	// element buffer binding is stored in the VAO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+	unsigned int* indices = (unsigned int*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, numIndices * sizeof(unsigned int), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+	// fall back to a single preallocated staging buffer if the driver refuses to map
+	std::vector<Vertex> stagingVertices;
+	std::vector<unsigned int> stagingIndices;
+	if (vertices == NULL || indices == NULL)
 	{
-		xTop.push_back(cosines[i] * topRadius);
-		zTop.push_back(sines[i] * topRadius);
-		xBottom.push_back(cosines[i] * bottomRadius);
-		zBottom.push_back(sines[i] * bottomRadius);
+		if (vertices != NULL)
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		if (indices != NULL)
+			glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+
+		stagingVertices.resize(numVerticesTotal);
+		stagingIndices.resize(numIndices);
+		vertices = stagingVertices.data();
+		indices = stagingIndices.data();
 	}
 
-	std::vector<glm::vec3> postions;
-	std::vector<glm::vec2> texCoords;
-	std::vector<glm::vec3> normals;
+	// first vertex of each circle: the center, followed by its ring
+	const int topCenter = numVerticesSide;
+	const int bottomCenter = numVerticesSide + (hasTop ? numVerticesTopBottom : 0);
+
+	const float halfHeight = height / 2.0f;
+	const UnitCircle& circle = UnitCircle::get(numSlices);		// shared sines/cosines for this slice count
+	const float sliceTextureStepU = 2.0f / float(numSlices);		// texture wraps twice around the object
 
 	/*
-	* POSTIONS
+	* VERTICES
 	*/
 
-	// calculate vertices for cone sides
-	for (auto i = 0; i <= numSlices; i++)
+	// walk the slices once, writing the side pair and both circle ring vertices for each
+	for (int i = 0; i <= numSlices; i++)
 	{
-		const auto topPosition = glm::vec3(xTop[i], height / 2.0f, zTop[i]);
-		const auto bottomPosition = glm::vec3(xBottom[i], -height / 2.0f, zBottom[i]);
-		postions.push_back(topPosition);
-		postions.push_back(bottomPosition);
-	}
-
-	// add top circle vertices
-
-	if (hasTop)
-	{
-		glm::vec3 topCenterPosition(0.0f, height / 2.0f, 0.0f);
-		postions.push_back(topCenterPosition);
-
-		for (auto i = 0; i <= numSlices; i++)
+		const float sine = circle.sines[i];
+		const float cosine = circle.cosines[i];
+		const float u = i * sliceTextureStepU;
+
+		// sides
+		Vertex& sideTop = vertices[i * 2];
+		sideTop.postion = glm::vec3(cosine * topRadius, halfHeight, sine * topRadius);
+		sideTop.texCoords = glm::vec2(u, 1.0f);
+		sideTop.normal = glm::vec3(cosine, 0.0f, sine);
+
+		Vertex& sideBottom = vertices[i * 2 + 1];
+		sideBottom.postion = glm::vec3(cosine * bottomRadius, -halfHeight, sine * bottomRadius);
+		sideBottom.texCoords = glm::vec2(u, 0.0f);
+		sideBottom.normal = glm::vec3(cosine, 0.0f, sine);
+
+		// top circle ring
+		if (hasTop)
 		{
-			const auto topPosition = glm::vec3(xTop[i], height / 2.0f, zTop[i]);
-			postions.push_back(topPosition);
+			Vertex& top = vertices[topCenter + 1 + i];
+			top.postion = glm::vec3(cosine * topRadius, halfHeight, sine * topRadius);
+			top.texCoords = glm::vec2(0.5f + sine * 0.5f, 0.5f + cosine * 0.5f);
+			top.normal = glm::vec3(0.0f, 1.0f, 0.0f);
 		}
-	}
-	
-	// add bottom circle vertices
-	if (hasBottom)
-	{
-		glm::vec3 bottomCenterPosition(0.0f, -height / 2.0f, 0.0f);
-		postions.push_back(bottomCenterPosition);
 
-		for (auto i = 0; i <= numSlices; i++)
+		// bottom circle ring
+		if (hasBottom)
 		{
-			const auto bottomPosition = glm::vec3(xBottom[i], -height / 2.0f, -zBottom[i]);
-			postions.push_back(bottomPosition);
+			Vertex& bottom = vertices[bottomCenter + 1 + i];
+			bottom.postion = glm::vec3(cosine * bottomRadius, -halfHeight, sine * bottomRadius);
+			bottom.texCoords = glm::vec2(0.5f - sine * 0.5f, 0.5f - cosine * 0.5f);
+			bottom.normal = glm::vec3(0.0f, -1.0f, 0.0f);
 		}
 	}
-	
-
-	/*
-	* TEXTURES
-	*/
-
-	// calculate texture coord for two wraps around object
-	const auto sliceTextureStepU = 2.0f / float(numSlices);
-	auto currentSliceTexCoordU = 0.0f;
-
-	for (auto i = 0; i <= numSlices; i++)
-	{
-		texCoords.push_back(glm::vec2(currentSliceTexCoordU, 1.0f));
-		texCoords.push_back(glm::vec2(currentSliceTexCoordU, 0.0f));
-
-		// update texture coordinate of current slice 
-		currentSliceTexCoordU += sliceTextureStepU;
-	}
 
-	// generate texture coords for top circle
-	glm::vec2 topBottomCenterTexCoord(0.5f, 0.5f);
+	// circle centers
 	if (hasTop)
 	{
-		texCoords.push_back(topBottomCenterTexCoord);
-		for (auto i = 0; i <= numSlices; i++)
-		{
-			texCoords.push_back(glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y + cosines[i] * 0.5f));
-		}
+		Vertex& center = vertices[topCenter];
+		center.postion = glm::vec3(0.0f, halfHeight, 0.0f);
+		center.texCoords = glm::vec2(0.5f, 0.5f);
+		center.normal = glm::vec3(0.0f, 1.0f, 0.0f);
 	}
-	
-	// generate texture coords for bottom circle
+
 	if (hasBottom)
 	{
-		texCoords.push_back(topBottomCenterTexCoord);
-		for (auto i = 0; i <= numSlices; i++)
-		{
-			texCoords.push_back(glm::vec2(topBottomCenterTexCoord.x + sines[i] * 0.5f, topBottomCenterTexCoord.y - cosines[i] * 0.5f));
-		}
+		Vertex& center = vertices[bottomCenter];
+		center.postion = glm::vec3(0.0f, -halfHeight, 0.0f);
+		center.texCoords = glm::vec2(0.5f, 0.5f);
+		center.normal = glm::vec3(0.0f, -1.0f, 0.0f);
 	}
-	
 
 	/*
-	* NORMALS
+	* INDICES
 	*/
-	for (auto i = 0; i <= numSlices; i++)
-	{
-		normals.push_back(glm::vec3(cosines[i], 0.0f, sines[i]));
-		normals.push_back(glm::vec3(cosines[i], 0.0f, sines[i]));
-	}
 
-	// add normals for all vertices in top circle
-	if (hasTop)
+	// triangle list for the sides and the top/bottom fans, all counter-clockwise seen
+	// from outside so back faces can be culled. the slices run from +x towards +z,
+	// which is clockwise seen from above
+	unsigned int* index = indices;
+	for (unsigned int i = 0; i < (unsigned int)numSlices; i++)
 	{
-		for (auto i = 0; i <= numVerticesTopBottom; i++)
+		// two triangles per slice for the sides
+		const unsigned int top = i * 2;
+		const unsigned int bottom = top + 1;
+
+		*index++ = top;
+		*index++ = top + 2;
+		*index++ = bottom;
+
+		*index++ = top + 2;
+		*index++ = bottom + 2;
+		*index++ = bottom;
+
+		// one triangle per slice for each circle, fanning out from the center vertex
+		if (hasTop)
 		{
-			normals.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+			*index++ = topCenter;
+			*index++ = topCenter + 2 + i;
+			*index++ = topCenter + 1 + i;
 		}
-	}
-	
-	// add normals for all vertices in bottom circle
-	if (hasBottom)
-	{
-		for (auto i = 0; i <= numVerticesTopBottom; i++)
+
+		if (hasBottom)
 		{
-			normals.push_back(glm::vec3(0.0f, -1.0f, 0.0f));
+			*index++ = bottomCenter;
+			*index++ = bottomCenter + 1 + i;
+			*index++ = bottomCenter + 2 + i;
 		}
 	}
-	
 
-	/*
-	* CREATE VERTICES
-	*/
-	std::vector<Vertex> vertices;
-	for (int i = 0; i < postions.size(); i++)
+	// hand the data to GL
+	if (stagingVertices.empty())
 	{
-		Vertex vertex;
-
-		vertex.postion = postions.at(i);
-		vertex.texCoords = texCoords.at(i);
-		vertex.normal = normals.at(i);
-
-		vertices.push_back(vertex);
+		glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	else
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, numVerticesTotal * sizeof(Vertex), vertices);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, numIndices * sizeof(unsigned int), indices);
 	}
-
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices.front(), GL_STATIC_DRAW);
 
 	// vertex positions
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);					
@@ -190,27 +191,88 @@ Cylinder::Cylinder(float topRadius, float bottomRadius, int numSlices, float hei
 	// vertex normals
 	glEnableVertexAttribArray(2);
 	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	// per-instance model and normal matrices
+	instanceBuffer.attach();
 }
 
 void Cylinder::render() const
 {
-	glBindVertexArray(VAO);
+	glState.bindVertexArray(VAO);
 
-	// render sides of cone
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, numVerticesSide);
+	// render sides, top and bottom circles in one call
+	glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, (void*)0);
+	renderStats.drawCalls++;
+}
 
-	// render top circle
-	
-	glDrawArrays(GL_TRIANGLE_FAN, numVerticesSide, numVerticesTopBottom);
-	
+void Cylinder::renderInstanced(const glm::mat4* models, int count)
+{
+	instanceBuffer.upload(models, count);
 
-	// render bottom circle
-	
-	glDrawArrays(GL_TRIANGLE_FAN, numVerticesSide + numVerticesTopBottom, numVerticesTopBottom);
-	
+	glState.bindVertexArray(VAO);
+	glDrawElementsInstanced(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, (void*)0, count);
+	renderStats.drawCalls++;
 }
 
 void Cylinder::deleteVBO()
 {
 	glDeleteBuffers(1 ,&VBO);
+	glDeleteBuffers(1, &EBO);
+	instanceBuffer.deleteVBO();
+	glState.deleteVertexArray(VAO);
+}
+
+void Cylinder::occluderTriangles(std::vector<glm::vec3>& triangles) const
+{
+	// a polygon with its corners on the circles lies inside them. the sides face
+	// outwards only: seen from inside an open cylinder the polygon's chords would be
+	// in front of the wall and could hide props that are really in view. a cap of an
+	// open cylinder can be seen from both sides, so it faces both ways
+	const UnitCircle& circle = UnitCircle::get(OCCLUDER_SLICES);
+	const float halfHeight = height / 2.0f;
+	const glm::vec3 topCenter(0.0f, halfHeight, 0.0f);
+	const glm::vec3 bottomCenter(0.0f, -halfHeight, 0.0f);
+	const bool open = !(hasTop && hasBottom);
+
+	for (int i = 0; i < OCCLUDER_SLICES; i++)
+	{
+		const glm::vec3 top0(circle.cosines[i] * topRadius, halfHeight, circle.sines[i] * topRadius);
+		const glm::vec3 top1(circle.cosines[i + 1] * topRadius, halfHeight, circle.sines[i + 1] * topRadius);
+		const glm::vec3 bottom0(circle.cosines[i] * bottomRadius, -halfHeight, circle.sines[i] * bottomRadius);
+		const glm::vec3 bottom1(circle.cosines[i + 1] * bottomRadius, -halfHeight, circle.sines[i + 1] * bottomRadius);
+
+		// same winding as the mesh
+		triangles.push_back(top0);
+		triangles.push_back(top1);
+		triangles.push_back(bottom0);
+
+		triangles.push_back(top1);
+		triangles.push_back(bottom1);
+		triangles.push_back(bottom0);
+
+		if (hasTop)
+		{
+			triangles.push_back(topCenter);
+			triangles.push_back(top1);
+			triangles.push_back(top0);
+			if (open)
+			{
+				triangles.push_back(topCenter);
+				triangles.push_back(top0);
+				triangles.push_back(top1);
+			}
+		}
+
+		if (hasBottom)
+		{
+			triangles.push_back(bottomCenter);
+			triangles.push_back(bottom0);
+			triangles.push_back(bottom1);
+			if (open)
+			{
+				triangles.push_back(bottomCenter);
+				triangles.push_back(bottom1);
+				triangles.push_back(bottom0);
+			}
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 330 core
+
+// depth pre-pass: colour writes are masked off, only the depth test runs
+void main()
+{
+}
\ No newline at end of file
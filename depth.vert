@@ -0,0 +1,35 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aInstanceModel;			// per instance, locations 3-6
+
+// same blocks as shader.vert, only the matrices are read
+layout (std140) uniform FrameData
+{
+	mat4 projection;
+	mat4 view;
+	vec3 viewPos;
+	vec3 lightPos;
+	vec3 lightColor;
+};
+
+layout (std140) uniform ObjectData
+{
+	mat4 model;
+	mat3 normalMatrix;
+};
+
+uniform bool instanced;		// read the model matrix from the instance attributes
+
+// must match shader.vert bit for bit so the colour pass passes GL_LEQUAL
+invariant gl_Position;
+
+void main()
+{
+	vec3 fragPos;
+	if (instanced)
+		fragPos = vec3(aInstanceModel * vec4(aPos, 1.0));
+	else
+		fragPos = vec3(model * vec4(aPos, 1.0));
+
+	gl_Position = projection * view * vec4(fragPos, 1.0f);
+}
\ No newline at end of file
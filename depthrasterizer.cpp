@@ -0,0 +1,312 @@
+// STL
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE intrinsics, every x64 target has them
+#if defined(_M_X64) || defined(__SSE__)
+#define RASTERIZER_SSE
+#include <xmmintrin.h>
+#endif
+
+// Project
+#include "depthrasterizer.h"
+
+DepthRasterizer::DepthRasterizer(unsigned int numThreads)
+	: depth(WIDTH * HEIGHT, 1.0f),
+	blockMax(BLOCKS_X * BLOCKS_Y, 1.0f),
+	viewProjection(1.0f),
+	nextTile(0),
+	generation(0),
+	workersDone(0),
+	running(false),
+	quit(false)
+{
+	if (numThreads == 0)
+		numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+	for (unsigned int i = 0; i < numThreads; i++)
+		workers.push_back(std::thread(&DepthRasterizer::workerLoop, this));
+}
+
+DepthRasterizer::~DepthRasterizer()
+{
+	finish();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	startCondition.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+void DepthRasterizer::setOccluders(const std::vector<glm::vec3>& triangles)
+{
+	finish();
+	occluders = triangles;
+}
+
+void DepthRasterizer::begin(const glm::mat4& viewProjection)
+{
+	finish();
+	this->viewProjection = viewProjection;
+
+	// transform and bin on this thread, there are only a few occluder triangles
+	triangles.clear();
+	for (std::vector<unsigned int>& bin : bins)
+		bin.clear();
+
+	for (size_t first = 0; first + 2 < occluders.size(); first += 3)
+	{
+		ScreenTriangle triangle;
+		bool crossesNearPlane = false;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const glm::vec4 clip = viewProjection * glm::vec4(occluders[first + corner], 1.0f);
+			if (clip.z < -clip.w || clip.w <= 0.0f)
+			{
+				crossesNearPlane = true;
+				break;
+			}
+			triangle.x[corner] = (clip.x / clip.w * 0.5f + 0.5f) * WIDTH;
+			triangle.y[corner] = (clip.y / clip.w * 0.5f + 0.5f) * HEIGHT;
+			triangle.z[corner] = clip.z / clip.w * 0.5f + 0.5f;
+		}
+		if (crossesNearPlane)
+			continue;
+
+		// tiles touched by the triangle's screen box
+		const float minX = std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]));
+		const float maxX = std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]));
+		const float minY = std::min(triangle.y[0], std::min(triangle.y[1], triangle.y[2]));
+		const float maxY = std::max(triangle.y[0], std::max(triangle.y[1], triangle.y[2]));
+		if (maxX < 0.0f || maxY < 0.0f || minX >= WIDTH || minY >= HEIGHT)
+			continue;
+
+		const int tileX0 = std::max(0, (int)minX / TILE_SIZE);
+		const int tileX1 = std::min(TILES_X - 1, (int)maxX / TILE_SIZE);
+		const int tileY0 = std::max(0, (int)minY / TILE_SIZE);
+		const int tileY1 = std::min(TILES_Y - 1, (int)maxY / TILE_SIZE);
+
+		const unsigned int index = (unsigned int)triangles.size();
+		triangles.push_back(triangle);
+		for (int tileY = tileY0; tileY <= tileY1; tileY++)
+		{
+			for (int tileX = tileX0; tileX <= tileX1; tileX++)
+				bins[tileY * TILES_X + tileX].push_back(index);
+		}
+	}
+
+	// hand the tiles to the workers
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		nextTile = 0;
+		workersDone = 0;
+		generation++;
+		running = true;
+	}
+	startCondition.notify_all();
+}
+
+void DepthRasterizer::finish()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this] { return !running || workersDone == workers.size(); });
+	running = false;
+}
+
+void DepthRasterizer::workerLoop()
+{
+	unsigned int seenGeneration = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [this, seenGeneration] { return quit || generation != seenGeneration; });
+			if (quit)
+				return;
+			seenGeneration = generation;
+		}
+
+		for (int tile = nextTile++; tile < TILES_X * TILES_Y; tile = nextTile++)
+			rasterizeTile(tile);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			workersDone++;
+		}
+		doneCondition.notify_one();
+	}
+}
+
+void DepthRasterizer::rasterizeTile(int tile)
+{
+	const int tileX = (tile % TILES_X) * TILE_SIZE;
+	const int tileY = (tile / TILES_X) * TILE_SIZE;
+
+	for (int y = tileY; y < tileY + TILE_SIZE; y++)
+		std::fill(&depth[y * WIDTH + tileX], &depth[y * WIDTH + tileX] + TILE_SIZE, 1.0f);
+
+	for (unsigned int index : bins[tile])
+	{
+		const ScreenTriangle& triangle = triangles[index];
+
+		// back faces and slivers are skipped, front faces are counter-clockwise
+		const float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+			(triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+		if (area < 1e-6f)
+			continue;
+
+		// edge functions a * x + b * y + c, positive inside. edge i is opposite
+		// corner i, so divided by the area it is that corner's barycentric weight
+		float a[3], b[3], c[3];
+		for (int edge = 0; edge < 3; edge++)
+		{
+			const int from = (edge + 1) % 3;
+			const int to = (edge + 2) % 3;
+			a[edge] = triangle.y[from] - triangle.y[to];
+			b[edge] = triangle.x[to] - triangle.x[from];
+			c[edge] = -(a[edge] * triangle.x[from] + b[edge] * triangle.y[from]);
+		}
+
+		// depth is linear in screen space
+		const float zA = (a[0] * triangle.z[0] + a[1] * triangle.z[1] + a[2] * triangle.z[2]) / area;
+		const float zB = (b[0] * triangle.z[0] + b[1] * triangle.z[1] + b[2] * triangle.z[2]) / area;
+		float zC = (c[0] * triangle.z[0] + c[1] * triangle.z[1] + c[2] * triangle.z[2]) / area;
+
+		// a covered pixel takes the farthest depth of the triangle's plane over its
+		// square, not the one at its centre
+		zC += 0.5f * (std::fabs(zA) + std::fabs(zB));
+
+		// pixels of the tile under the triangle's box, x aligned down to a group of four
+		const float minX = std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]));
+		const float maxX = std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]));
+		const float minY = std::min(triangle.y[0], std::min(triangle.y[1], triangle.y[2]));
+		const float maxY = std::max(triangle.y[0], std::max(triangle.y[1], triangle.y[2]));
+		const int x0 = std::max(tileX, (int)minX) & ~3;
+		const int x1 = std::min(tileX + TILE_SIZE - 1, (int)maxX);
+		const int y0 = std::max(tileY, (int)minY);
+		const int y1 = std::min(tileY + TILE_SIZE - 1, (int)maxY);
+
+#ifdef RASTERIZER_SSE
+		const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 zero = _mm_setzero_ps();
+		for (int y = y0; y <= y1; y++)
+		{
+			const float centerY = y + 0.5f;
+			const __m128 row0 = _mm_set1_ps(b[0] * centerY + c[0]);
+			const __m128 row1 = _mm_set1_ps(b[1] * centerY + c[1]);
+			const __m128 row2 = _mm_set1_ps(b[2] * centerY + c[2]);
+			const __m128 rowZ = _mm_set1_ps(zB * centerY + zC);
+
+			for (int x = x0; x <= x1; x += 4)
+			{
+				const __m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+				const __m128 edge0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), centerX), row0);
+				const __m128 edge1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[1]), centerX), row1);
+				const __m128 edge2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), centerX), row2);
+				const __m128 inside = _mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_and_ps(_mm_cmpge_ps(edge1, zero), _mm_cmpge_ps(edge2, zero)));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				float* pixels = &depth[y * WIDTH + x];
+				const __m128 previous = _mm_loadu_ps(pixels);
+				const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), centerX), rowZ);
+				const __m128 nearest = _mm_min_ps(previous, z);
+				_mm_storeu_ps(pixels, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+			}
+		}
+#else
+		for (int y = y0; y <= y1; y++)
+		{
+			const float centerY = y + 0.5f;
+			for (int x = x0; x <= x1; x++)
+			{
+				const float centerX = x + 0.5f;
+				if (a[0] * centerX + b[0] * centerY + c[0] < 0.0f ||
+					a[1] * centerX + b[1] * centerY + c[1] < 0.0f ||
+					a[2] * centerX + b[2] * centerY + c[2] < 0.0f)
+					continue;
+
+				float& pixel = depth[y * WIDTH + x];
+				pixel = std::min(pixel, zA * centerX + zB * centerY + zC);
+			}
+		}
+#endif
+	}
+
+	// farthest depth of each block for the coarse test
+	for (int blockY = tileY / BLOCK_SIZE; blockY < (tileY + TILE_SIZE) / BLOCK_SIZE; blockY++)
+	{
+		for (int blockX = tileX / BLOCK_SIZE; blockX < (tileX + TILE_SIZE) / BLOCK_SIZE; blockX++)
+		{
+			float farthest = 0.0f;
+			for (int y = blockY * BLOCK_SIZE; y < (blockY + 1) * BLOCK_SIZE; y++)
+			{
+				for (int x = blockX * BLOCK_SIZE; x < (blockX + 1) * BLOCK_SIZE; x++)
+					farthest = std::max(farthest, depth[y * WIDTH + x]);
+			}
+			blockMax[blockY * BLOCKS_X + blockX] = farthest;
+		}
+	}
+}
+
+bool DepthRasterizer::isOccluded(const Bounds& bounds) const
+{
+	// screen rectangle and nearest depth of the box corners
+	float minX = FLT_MAX, maxX = -FLT_MAX;
+	float minY = FLT_MAX, maxY = -FLT_MAX;
+	float minZ = FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		const glm::vec3 sign((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+		const glm::vec4 clip = viewProjection * glm::vec4(bounds.center + sign * bounds.extents, 1.0f);
+
+		// reaching past the near plane, too close to say anything
+		if (clip.z < -clip.w || clip.w <= 0.0f)
+			return false;
+
+		const float x = (clip.x / clip.w * 0.5f + 0.5f) * WIDTH;
+		const float y = (clip.y / clip.w * 0.5f + 0.5f) * HEIGHT;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		minZ = std::min(minZ, clip.z / clip.w * 0.5f + 0.5f);
+	}
+
+	if (maxX < 0.0f || maxY < 0.0f || minX >= WIDTH || minY >= HEIGHT)
+		return false;
+
+	// a pixel is covered when its centre is, so an occluder can reach up to half a
+	// pixel past its real edge. one more pixel on every side of the bounds takes
+	// in one whose centre lies beyond that edge
+	const int x0 = std::max(0, (int)std::floor(minX) - 1);
+	const int x1 = std::min(WIDTH - 1, (int)std::floor(maxX) + 1);
+	const int y0 = std::max(0, (int)std::floor(minY) - 1);
+	const int y1 = std::min(HEIGHT - 1, (int)std::floor(maxY) + 1);
+
+	for (int blockY = y0 / BLOCK_SIZE; blockY <= y1 / BLOCK_SIZE; blockY++)
+	{
+		for (int blockX = x0 / BLOCK_SIZE; blockX <= x1 / BLOCK_SIZE; blockX++)
+		{
+			// everything in the block is nearer than the bounds
+			if (blockMax[blockY * BLOCKS_X + blockX] < minZ)
+				continue;
+
+			// otherwise look at the pixels the bounds cover in this block
+			const int pixelY1 = std::min(y1, (blockY + 1) * BLOCK_SIZE - 1);
+			const int pixelX1 = std::min(x1, (blockX + 1) * BLOCK_SIZE - 1);
+			for (int y = std::max(y0, blockY * BLOCK_SIZE); y <= pixelY1; y++)
+			{
+				for (int x = std::max(x0, blockX * BLOCK_SIZE); x <= pixelX1; x++)
+				{
+					if (depth[y * WIDTH + x] >= minZ)
+						return false;
+				}
+			}
+		}
+	}
+	return true;
+}
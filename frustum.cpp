@@ -0,0 +1,171 @@
+// STL
+#include <cfloat>
+#include <cmath>
+
+// SSE intrinsics, every x64 target has them
+#if defined(_M_X64) || defined(__SSE__)
+#define FRUSTUM_SSE
+#include <xmmintrin.h>
+#endif
+
+// Project
+#include "frustum.h"
+
+void BoundsArray::clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+	radius.clear();
+	count = 0;
+}
+
+void BoundsArray::push(const Bounds& bounds)
+{
+	// start a new group of four
+	if (count % 4 == 0)
+		pad();
+
+	centerX[count] = bounds.center.x;
+	centerY[count] = bounds.center.y;
+	centerZ[count] = bounds.center.z;
+	extentX[count] = bounds.extents.x;
+	extentY[count] = bounds.extents.y;
+	extentZ[count] = bounds.extents.z;
+	radius[count] = bounds.radius;
+	count++;
+}
+
+void BoundsArray::pad()
+{
+	// a hugely negative radius is outside of every plane
+	centerX.insert(centerX.end(), 4, 0.0f);
+	centerY.insert(centerY.end(), 4, 0.0f);
+	centerZ.insert(centerZ.end(), 4, 0.0f);
+	extentX.insert(extentX.end(), 4, 0.0f);
+	extentY.insert(extentY.end(), 4, 0.0f);
+	extentZ.insert(extentZ.end(), 4, 0.0f);
+	radius.insert(radius.end(), 4, -FLT_MAX);
+}
+
+Frustum::Frustum()
+{
+	for (int i = 0; i < 6; i++)
+		planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	// rows of the column-major matrix
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+
+	planes[0] = rows[3] + rows[0];	// left
+	planes[1] = rows[3] - rows[0];	// right
+	planes[2] = rows[3] + rows[1];	// bottom
+	planes[3] = rows[3] - rows[1];	// top
+	planes[4] = rows[3] + rows[2];	// near
+	planes[5] = rows[3] - rows[2];	// far
+
+	for (int i = 0; i < 6; i++)
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+bool Frustum::test(const Bounds& bounds) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const glm::vec4& plane = planes[i];
+		const float distance = plane.x * bounds.center.x + plane.y * bounds.center.y + plane.z * bounds.center.z + plane.w;
+
+		// the box and the sphere both enclose the object, the smaller reach is the tighter
+		const float boxReach = std::fabs(plane.x) * bounds.extents.x + std::fabs(plane.y) * bounds.extents.y + std::fabs(plane.z) * bounds.extents.z;
+		if (distance < -std::fmin(bounds.radius, boxReach))
+			return false;
+	}
+	return true;
+}
+
+Frustum::Containment Frustum::classify(const glm::vec3& center, const glm::vec3& extents) const
+{
+	Containment result = INSIDE;
+	for (int i = 0; i < 6; i++)
+	{
+		const glm::vec4& plane = planes[i];
+		const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		const float reach = std::fabs(plane.x) * extents.x + std::fabs(plane.y) * extents.y + std::fabs(plane.z) * extents.z;
+
+		if (distance < -reach)
+			return OUTSIDE;
+		if (distance < reach)
+			result = INTERSECTING;
+	}
+	return result;
+}
+
+void Frustum::testBatch(const BoundsArray& bounds, unsigned char* visible) const
+{
+	const unsigned int count = bounds.size();
+
+#ifdef FRUSTUM_SSE
+	// plane components splatted across the four lanes, absolute normals for the box reach
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m128 absX[6], absY[6], absZ[6];
+	for (int i = 0; i < 6; i++)
+	{
+		planeX[i] = _mm_set1_ps(planes[i].x);
+		planeY[i] = _mm_set1_ps(planes[i].y);
+		planeZ[i] = _mm_set1_ps(planes[i].z);
+		planeW[i] = _mm_set1_ps(planes[i].w);
+		absX[i] = _mm_set1_ps(std::fabs(planes[i].x));
+		absY[i] = _mm_set1_ps(std::fabs(planes[i].y));
+		absZ[i] = _mm_set1_ps(std::fabs(planes[i].z));
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	// four objects per iteration, the padding makes the last group complete
+	for (unsigned int first = 0; first < count; first += 4)
+	{
+		const __m128 centerX = _mm_loadu_ps(&bounds.centerX[first]);
+		const __m128 centerY = _mm_loadu_ps(&bounds.centerY[first]);
+		const __m128 centerZ = _mm_loadu_ps(&bounds.centerZ[first]);
+		const __m128 extentX = _mm_loadu_ps(&bounds.extentX[first]);
+		const __m128 extentY = _mm_loadu_ps(&bounds.extentY[first]);
+		const __m128 extentZ = _mm_loadu_ps(&bounds.extentZ[first]);
+		const __m128 radius = _mm_loadu_ps(&bounds.radius[first]);
+
+		__m128 outside = zero;
+		for (int i = 0; i < 6; i++)
+		{
+			const __m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[i], centerX), _mm_mul_ps(planeY[i], centerY)),
+				_mm_add_ps(_mm_mul_ps(planeZ[i], centerZ), planeW[i]));
+			const __m128 boxReach = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(absX[i], extentX), _mm_mul_ps(absY[i], extentY)),
+				_mm_mul_ps(absZ[i], extentZ));
+
+			// distance + min(radius, reach) < 0 means fully behind this plane
+			const __m128 reach = _mm_min_ps(radius, boxReach);
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), zero));
+		}
+
+		const int mask = _mm_movemask_ps(outside);
+		const unsigned int lanes = count - first < 4 ? count - first : 4;
+		for (unsigned int lane = 0; lane < lanes; lane++)
+			visible[first + lane] = (mask >> lane) & 1 ? 0 : 1;
+	}
+#else
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Bounds object;
+		object.center = glm::vec3(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+		object.extents = glm::vec3(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+		object.radius = bounds.radius[i];
+		visible[i] = test(object) ? 1 : 0;
+	}
+#endif
+}
@@ -0,0 +1,30 @@
+// STL
+#include <cstring>
+
+// Project
+#include "glextensions.h"
+
+TexStorage2DProc texStorage2D = NULL;
+
+bool hasExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+			return true;
+	}
+	return false;
+}
+
+void loadExtensions(GLADloadproc load)
+{
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+	texStorage2D = NULL;
+	if (major > 4 || (major == 4 && minor >= 2) || hasExtension("GL_ARB_texture_storage"))
+		texStorage2D = (TexStorage2DProc)load("glTexStorage2D");
+}
@@ -0,0 +1,226 @@
+// Project
+#include "glstate.h"
+#include "renderstats.h"
+
+GLState glState;
+
+// unnamed namespace
+namespace
+{
+	// texture targets and capabilities with a shadow; anything else passes straight through
+	const GLenum TEXTURE_TARGETS[] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP };
+	const GLenum CAPABILITIES[] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_POLYGON_OFFSET_FILL, GL_PRIMITIVE_RESTART };
+}
+
+GLState::GLState()
+{
+	invalidate();
+}
+
+void GLState::useProgram(unsigned int program)
+{
+	if (set(this->program, program))
+		glUseProgram(program);
+}
+
+void GLState::bindVertexArray(unsigned int vertexArray)
+{
+	if (set(this->vertexArray, vertexArray))
+		glBindVertexArray(vertexArray);
+}
+
+void GLState::bindTexture(GLenum target, unsigned int texture, unsigned int unit)
+{
+	const int index = targetIndex(target);
+	if (index < 0 || unit >= MAX_TEXTURE_UNITS)
+	{
+		// untracked, keep the shadow honest and issue it
+		if (set(activeUnit, GL_TEXTURE0 + unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(target, texture);
+		renderStats.stateChanges++;
+		return;
+	}
+
+	if (textures[unit][index] == texture)
+	{
+		renderStats.stateChangesFiltered++;
+		return;
+	}
+
+	if (set(activeUnit, GL_TEXTURE0 + unit))
+		glActiveTexture(GL_TEXTURE0 + unit);
+	set(textures[unit][index], texture);
+	glBindTexture(target, texture);
+}
+
+void GLState::bindSampler(unsigned int unit, unsigned int sampler)
+{
+	// sampler bindings name their unit, the active one stays
+	if (unit >= MAX_TEXTURE_UNITS)
+	{
+		glBindSampler(unit, sampler);
+		renderStats.stateChanges++;
+	}
+	else if (set(samplers[unit], sampler))
+		glBindSampler(unit, sampler);
+}
+
+void GLState::enable(GLenum capability)
+{
+	const int index = capabilityIndex(capability);
+	if (index < 0)
+	{
+		glEnable(capability);
+		renderStats.stateChanges++;
+	}
+	else if (set(capabilities[index], GL_TRUE))
+		glEnable(capability);
+}
+
+void GLState::disable(GLenum capability)
+{
+	const int index = capabilityIndex(capability);
+	if (index < 0)
+	{
+		glDisable(capability);
+		renderStats.stateChanges++;
+	}
+	else if (set(capabilities[index], GL_FALSE))
+		glDisable(capability);
+}
+
+void GLState::polygonMode(GLenum mode)
+{
+	if (set(polygon, mode))
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void GLState::depthFunc(GLenum func)
+{
+	if (set(depthFunction, func))
+		glDepthFunc(func);
+}
+
+void GLState::depthMask(bool write)
+{
+	if (set(depthWrite, write ? GL_TRUE : GL_FALSE))
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::colorMask(bool write)
+{
+	const GLboolean mask = write ? GL_TRUE : GL_FALSE;
+	if (set(colorWrite, mask))
+		glColorMask(mask, mask, mask, mask);
+}
+
+void GLState::clearColor(float red, float green, float blue, float alpha)
+{
+	if (clearKnown && clear[0] == red && clear[1] == green && clear[2] == blue && clear[3] == alpha)
+	{
+		renderStats.stateChangesFiltered++;
+		return;
+	}
+
+	clear[0] = red;
+	clear[1] = green;
+	clear[2] = blue;
+	clear[3] = alpha;
+	clearKnown = true;
+	glClearColor(red, green, blue, alpha);
+	renderStats.stateChanges++;
+}
+
+void GLState::deleteProgram(unsigned int program)
+{
+	glDeleteProgram(program);
+	if (this->program == program)
+		this->program = UNKNOWN;
+}
+
+void GLState::deleteVertexArray(unsigned int vertexArray)
+{
+	// deleting the bound VAO reverts the binding to zero
+	glDeleteVertexArrays(1, &vertexArray);
+	if (this->vertexArray == vertexArray)
+		this->vertexArray = 0;
+}
+
+void GLState::deleteTexture(unsigned int texture)
+{
+	// deleting a bound texture reverts its bindings to zero
+	glDeleteTextures(1, &texture);
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		for (int target = 0; target < NUM_TEXTURE_TARGETS; target++)
+		{
+			if (textures[unit][target] == texture)
+				textures[unit][target] = 0;
+		}
+	}
+}
+
+void GLState::deleteSampler(unsigned int sampler)
+{
+	// deleting a bound sampler reverts its units to zero
+	glDeleteSamplers(1, &sampler);
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		if (samplers[unit] == sampler)
+			samplers[unit] = 0;
+	}
+}
+
+void GLState::invalidate()
+{
+	program = UNKNOWN;
+	vertexArray = UNKNOWN;
+	activeUnit = UNKNOWN;
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		for (int target = 0; target < NUM_TEXTURE_TARGETS; target++)
+			textures[unit][target] = UNKNOWN;
+		samplers[unit] = UNKNOWN;
+	}
+	for (int i = 0; i < NUM_CAPABILITIES; i++)
+		capabilities[i] = UNKNOWN;
+	polygon = UNKNOWN;
+	depthFunction = UNKNOWN;
+	depthWrite = UNKNOWN;
+	colorWrite = UNKNOWN;
+	clearKnown = false;
+}
+
+bool GLState::set(unsigned int& shadow, unsigned int value)
+{
+	if (shadow == value)
+	{
+		renderStats.stateChangesFiltered++;
+		return false;
+	}
+
+	shadow = value;
+	renderStats.stateChanges++;
+	return true;
+}
+
+int GLState::targetIndex(GLenum target)
+{
+	for (int i = 0; i < NUM_TEXTURE_TARGETS; i++)
+	{
+		if (TEXTURE_TARGETS[i] == target)
+			return i;
+	}
+	return -1;
+}
+
+int GLState::capabilityIndex(GLenum capability)
+{
+	for (int i = 0; i < NUM_CAPABILITIES; i++)
+	{
+		if (CAPABILITIES[i] == capability)
+			return i;
+	}
+	return -1;
+}
@@ -0,0 +1,50 @@
+#ifndef BLOCKENCODER_H
+#define BLOCKENCODER_H
+
+// STL
+#include <cstddef>
+
+/*
+* CPU encoder for the block-compressed texture formats, run when a texture cache
+* is built so the GPU samples 4 bits (BC1) instead of 24 per texel.
+*
+* both formats store each 4x4 block of pixels in 8 bytes: two endpoints and an
+* index per pixel into the colours interpolated between them. blocks past the
+* right or bottom edge repeat the edge pixels.
+*
+* the image is split into bands of block rows encoded on several threads, and the
+* index search tests four pixels at a time against the palette with SSE.
+*/
+class BlockEncoder
+{
+public:
+	enum Quality
+	{
+		QUALITY_FAST,		// endpoints at the extremes along the principal axis
+		QUALITY_HIGH		// and then refined by least squares, about twice as slow
+	};
+
+	// bytes of a width x height image in either format
+	static size_t encodedSize(int width, int height);
+
+	// S3TC DXT1 / BC1, RGB pixels in rows of width * 3 bytes
+	static void encodeBC1(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+		Quality quality, unsigned int numThreads = 0);
+	// RGTC1 / BC4, one channel pixels in rows of width bytes
+	static void encodeRGTC1(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+		unsigned int numThreads = 0);
+
+private:
+	// encodes rows of blocks [firstRow, lastRow)
+	static void encodeBC1Rows(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+		Quality quality, int firstRow, int lastRow);
+	static void encodeRGTC1Rows(const unsigned char* pixels, int width, int height, unsigned char* blocks,
+		int firstRow, int lastRow);
+
+	// 16 pixels as floats, one array per channel
+	static void encodeBC1Block(const float* red, const float* green, const float* blue, Quality quality, unsigned char* block);
+	static void encodeRGTC1Block(const unsigned char* values, unsigned char* block);
+};
+
+
+#endif // !BLOCKENCODER_H
@@ -0,0 +1,50 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+// STL
+#include <cmath>
+#include <algorithm>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+/*
+* bounding volume of a mesh: an axis-aligned box and the sphere around the same center.
+* meshes fill theirs in object space at construction, the render queue transforms it
+* by each model matrix and culls whatever lies outside the view frustum.
+*/
+struct Bounds
+{
+	glm::vec3 center = glm::vec3(0.0f);
+	glm::vec3 extents = glm::vec3(0.0f);	// half the box size along each axis
+	float radius = 0.0f;					// sphere around center, can be tighter than the box corner
+};
+
+/*
+* returns the bounds enclosing the given object-space bounds after the model transform.
+* the box is the world-aligned box around the transformed one, the sphere radius grows
+* with the largest axis scale.
+*/
+inline Bounds transformBounds(const Bounds& bounds, const glm::mat4& model)
+{
+	Bounds world;
+	world.center = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+
+	// each world axis picks up the extents through the absolute rotation and scale
+	for (int axis = 0; axis < 3; axis++)
+	{
+		world.extents[axis] = std::fabs(model[0][axis]) * bounds.extents.x +
+			std::fabs(model[1][axis]) * bounds.extents.y +
+			std::fabs(model[2][axis]) * bounds.extents.z;
+	}
+
+	// the longest basis column is the largest scale
+	const glm::vec3 x(model[0]), y(model[1]), z(model[2]);
+	const float maxScale = std::max(glm::dot(x, x), std::max(glm::dot(y, y), glm::dot(z, z)));
+	world.radius = bounds.radius * std::sqrt(maxScale);
+
+	return world;
+}
+
+
+#endif // !BOUNDS_H
@@ -0,0 +1,77 @@
+#ifndef BVH_H
+#define BVH_H
+
+// STL
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+// Project
+#include "bounds.h"
+#include "frustum.h"
+
+/*
+* bounding volume hierarchy over the world-space boxes of scene objects, built top down
+* with the surface area heuristic over binned centroids. queries return object indices,
+* i.e. positions in the vector the tree was built from.
+*
+* when objects move but the scene keeps its layout, refit() updates the node boxes in
+* one bottom-up pass instead of building again. the tree gets looser the further the
+* objects travel from where they were at build time.
+*/
+class BVH
+{
+public:
+	void build(const std::vector<Bounds>& objects);
+	// same objects in the same order, only their bounds changed
+	void refit(const std::vector<Bounds>& objects);
+
+	// appends the objects at least partly inside the frustum
+	void queryFrustum(const Frustum& frustum, std::vector<unsigned int>& result) const;
+	// appends the objects whose boxes touch the sphere
+	void querySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& result) const;
+	// nearest object whose box the ray enters within maxDistance, -1 if there is none.
+	// direction does not need to be normalized, distance is in units of its length
+	int raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const;
+
+	unsigned int nodeCount() const { return (unsigned int)nodes.size(); }
+
+private:
+	static const unsigned int MAX_LEAF_SIZE = 4;
+	static const int NUM_BINS = 12;
+
+	struct Node
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+		unsigned int left;		// first of the two children, 0 for leaves (the root is never a child)
+		unsigned int first;		// range of the subtree in indices
+		unsigned int count;
+	};
+
+	// splits the node along the cheapest binned SAH plane, or leaves it a leaf.
+	// the node box is already set, the centroid box is the one of its objects
+	void subdivide(unsigned int nodeIndex, const glm::vec3& centroidMin, const glm::vec3& centroidMax);
+	void growToObjects(Node& node) const;
+	// entry distance of the ray into the box, or a negative value on a miss
+	static float intersect(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance);
+
+	std::vector<Node> nodes;
+	std::vector<unsigned int> indices;		// object indices, each subtree owns a contiguous range
+
+	// object boxes, kept for the leaf tests. min and max side by side so a
+	// lookup touches one cache line
+	struct Box
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+	std::vector<Box> boxes;
+
+	// traversal stack of the queries, kept so they do not allocate per call
+	mutable std::vector<unsigned int> stack;
+};
+
+
+#endif // !BVH_H
@@ -5,7 +5,11 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 
-class Cylinder
+// Project
+#include "mesh.h"
+#include "instancebuffer.h"
+
+class Cylinder : public Mesh
 {
 public:
 	struct Vertex {
@@ -15,15 +19,28 @@ public:
 	};
 
 	Cylinder(float topRadius, float bottomRadius, int numSlices, float height, bool topCircle, bool bottomCirlce);
-	void render() const;
-	void deleteVBO();
+	void render() const override;
+	void renderInstanced(const glm::mat4* models, int count) override;	// one draw for all model matrices
+	void deleteVBO() override;
+	unsigned int vertexArray() const override { return VAO; }
+	void occluderTriangles(std::vector<glm::vec3>& triangles) const override;
 
 private:
+	// slices of the occluder, few enough for the CPU rasterizer
+	static const int OCCLUDER_SLICES = 8;
+
+	float topRadius;
+	float bottomRadius;
+	float height;
+
 	int numVerticesSide;		// How many vertices to render side of the cylinder
 	int numVerticesTopBottom;	// How many vertices to render top / bottom of the cylinder
 	int numVerticesTotal;		// Just a sum of both numbers above
+	int numIndices;				// How many indices to render the whole cylinder
+
+	InstanceBuffer instanceBuffer;	// per-instance matrices, attached to the VAO
 
-	unsigned int VAO, VBO;
+	unsigned int VAO, VBO, EBO;
 
 	bool hasTop;
 	bool hasBottom;
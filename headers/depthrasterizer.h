@@ -0,0 +1,100 @@
+#ifndef DEPTHRASTERIZER_H
+#define DEPTHRASTERIZER_H
+
+// STL
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+// Project
+#include "bounds.h"
+
+/*
+* software occlusion culling: a small CPU rasterizer that draws coarse occluder
+* triangles into a low-resolution depth buffer, so object bounds can be tested
+* against it without reading anything back from the GPU.
+*
+* begin() transforms the occluders and bins them into screen tiles on the calling
+* thread, then worker threads rasterize the tiles (four pixels at a time with SSE)
+* while the caller carries on with the frame: streaming textures, clearing and
+* submitting the draws that are never culled. finish() waits for them. each
+* tile also keeps the farthest depth of every 8x8 block (a one-level hierarchical Z),
+* so most bounds are decided without touching single pixels.
+*
+* occluders must lie inside the real geometry they stand for, or objects that are
+* visible can be culled. like GL, front faces are counter-clockwise and back faces
+* are skipped. a pixel holds the farthest depth the triangle has over it, and
+* bounds are tested with a margin of one pixel, so the low resolution never lets
+* an occluder hide what sticks out past its edges. triangles crossing the near
+* plane are skipped too. all of this only ever makes the culling less aggressive.
+*/
+class DepthRasterizer
+{
+public:
+	static const int WIDTH = 256;
+	static const int HEIGHT = 128;
+	static const int TILE_SIZE = 32;
+	static const int BLOCK_SIZE = 8;
+
+	// numThreads 0 picks one less than the hardware threads, at least one
+	explicit DepthRasterizer(unsigned int numThreads = 0);
+	~DepthRasterizer();
+
+	// world-space occluders, three vertices per triangle
+	void setOccluders(const std::vector<glm::vec3>& triangles);
+
+	// starts rasterizing the occluders seen through viewProjection
+	void begin(const glm::mat4& viewProjection);
+	// waits for the workers, after this isOccluded() may be called
+	void finish();
+
+	// true when the bounds are hidden behind the occluders in every pixel they cover
+	bool isOccluded(const Bounds& bounds) const;
+
+	// depth of a pixel, 0 at the near plane and 1 at the far plane or where nothing was drawn
+	float depthAt(int x, int y) const { return depth[y * WIDTH + x]; }
+
+private:
+	static const int TILES_X = WIDTH / TILE_SIZE;
+	static const int TILES_Y = HEIGHT / TILE_SIZE;
+	static const int BLOCKS_X = WIDTH / BLOCK_SIZE;
+	static const int BLOCKS_Y = HEIGHT / BLOCK_SIZE;
+
+	// triangle in pixel coordinates with depth from 0 to 1
+	struct ScreenTriangle
+	{
+		float x[3];
+		float y[3];
+		float z[3];
+	};
+
+	void workerLoop();
+	void rasterizeTile(int tile);
+
+	std::vector<glm::vec3> occluders;
+	std::vector<ScreenTriangle> triangles;
+	std::vector<unsigned int> bins[TILES_X * TILES_Y];		// triangle indices per tile
+
+	std::vector<float> depth;		// WIDTH * HEIGHT
+	std::vector<float> blockMax;	// farthest depth per 8x8 block
+	glm::mat4 viewProjection;
+
+	// worker threads pick tiles off nextTile until all are taken
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable startCondition;
+	std::condition_variable doneCondition;
+	std::atomic<int> nextTile;
+	unsigned int generation;		// bumped by begin() to wake the workers
+	unsigned int workersDone;
+	bool running;					// a frame is being rasterized
+	bool quit;
+};
+
+
+#endif // !DEPTHRASTERIZER_H
@@ -0,0 +1,66 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+// STL
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+// Project
+#include "bounds.h"
+
+/*
+* world-space bounds of many objects stored as separate arrays per component, so the
+* frustum test can load four objects into one SSE register at a time. the arrays are
+* padded to a multiple of four with bounds that never pass the test.
+*/
+class BoundsArray
+{
+public:
+	void clear();
+	void push(const Bounds& bounds);
+	unsigned int size() const { return count; }
+
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+	std::vector<float> radius;
+
+private:
+	void pad();
+
+	unsigned int count = 0;
+};
+
+/*
+* the six planes of the view volume, extracted from projection * view.
+* plane normals point inwards and are normalized, so dot(normal, p) + w is the
+* signed distance of p from the plane.
+*/
+class Frustum
+{
+public:
+	// result of testing a box against all six planes
+	enum Containment
+	{
+		OUTSIDE,
+		INTERSECTING,
+		INSIDE
+	};
+
+	Frustum();		// accepts everything
+	explicit Frustum(const glm::mat4& viewProjection);
+
+	// true when the bounds are at least partly inside
+	bool test(const Bounds& bounds) const;
+	// box given by center and half extents, telling partly and fully inside apart
+	Containment classify(const glm::vec3& center, const glm::vec3& extents) const;
+	// writes 1 to visible[i] for every object of the array that is at least partly
+	// inside, 0 otherwise
+	void testBatch(const BoundsArray& bounds, unsigned char* visible) const;
+
+	glm::vec4 planes[6];
+};
+
+
+#endif // !FRUSTUM_H
@@ -0,0 +1,29 @@
+#ifndef GLEXTENSIONS_H
+#define GLEXTENSIONS_H
+
+// GLAD header
+#include <glad/glad.h>
+
+// GL_EXT_texture_compression_s3tc, not part of the 3.3 core GLAD loader
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+// GL_EXT_texture_filter_anisotropic, core only from GL 4.6
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+// glTexStorage2D, core from GL 4.2 or through GL_ARB_texture_storage. NULL
+// when the context has neither
+typedef void (APIENTRYP TexStorage2DProc)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+extern TexStorage2DProc texStorage2D;
+
+// true when the current context advertises the named extension
+bool hasExtension(const char* name);
+// loads the entry points above, after GLAD on the current context
+void loadExtensions(GLADloadproc load);
+
+
+#endif // !GLEXTENSIONS_H
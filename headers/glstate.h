@@ -0,0 +1,71 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+// GLAD header
+#include <glad/glad.h>
+
+/*
+* shadows the GL state the renderer changes most often and drops calls that would
+* set it to the value it already has. all binds/enables of the tracked state must go
+* through here (or be followed by invalidate()) for the shadow to stay correct.
+*
+* issued and filtered calls are counted in renderStats.
+*/
+class GLState
+{
+public:
+	GLState();
+
+	void useProgram(unsigned int program);
+	void bindVertexArray(unsigned int vertexArray);
+	// binds to the given texture unit, switching the active unit only when needed
+	void bindTexture(GLenum target, unsigned int texture, unsigned int unit = 0);
+	// sampler 0 leaves the unit to the texture's own parameters
+	void bindSampler(unsigned int unit, unsigned int sampler);
+	void enable(GLenum capability);
+	void disable(GLenum capability);
+	void polygonMode(GLenum mode);		// applied to GL_FRONT_AND_BACK
+	void depthFunc(GLenum func);
+	void depthMask(bool write);
+	void colorMask(bool write);			// applied to all four channels
+	void clearColor(float red, float green, float blue, float alpha);
+
+	// delete objects and forget them, their names may be handed out again
+	void deleteProgram(unsigned int program);
+	void deleteVertexArray(unsigned int vertexArray);
+	void deleteTexture(unsigned int texture);
+	void deleteSampler(unsigned int sampler);
+
+	// forget everything, for when code outside the tracker has touched GL state
+	void invalidate();
+
+private:
+	static const unsigned int UNKNOWN = 0xFFFFFFFF;
+	static const int MAX_TEXTURE_UNITS = 16;
+	static const int NUM_TEXTURE_TARGETS = 3;
+	static const int NUM_CAPABILITIES = 7;
+
+	// returns false and counts a filtered call when the shadowed value already matches
+	bool set(unsigned int& shadow, unsigned int value);
+	static int targetIndex(GLenum target);
+	static int capabilityIndex(GLenum capability);
+
+	unsigned int program;
+	unsigned int vertexArray;
+	unsigned int activeUnit;
+	unsigned int textures[MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+	unsigned int samplers[MAX_TEXTURE_UNITS];
+	unsigned int capabilities[NUM_CAPABILITIES];	// GL_TRUE / GL_FALSE / UNKNOWN
+	unsigned int polygon;
+	unsigned int depthFunction;
+	unsigned int depthWrite;		// GL_TRUE / GL_FALSE / UNKNOWN
+	unsigned int colorWrite;		// GL_TRUE / GL_FALSE / UNKNOWN
+	float clear[4];
+	bool clearKnown;
+};
+
+// tracker for the one GL context, defined in glstate.cpp
+extern GLState glState;
+
+
+#endif // !GLSTATE_H
@@ -0,0 +1,35 @@
+#ifndef INSTANCEBUFFER_H
+#define INSTANCEBUFFER_H
+
+// STL
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+/*
+* per-instance vertex attributes for instanced drawing: a model matrix at locations 3-6
+* and its normal matrix at locations 7-9, advancing once per instance
+*/
+class InstanceBuffer
+{
+public:
+	struct Instance {
+		glm::mat4 model;
+		glm::mat3 normalMatrix;
+	};
+
+	// creates the buffer and adds the instance attributes to the currently bound VAO
+	void attach();
+	// fills the buffer with one instance per model matrix
+	void upload(const glm::mat4* models, int count);
+	void deleteVBO();
+
+private:
+	unsigned int VBO;
+	int capacity;						// instances the GL buffer currently holds
+	std::vector<Instance> instances;	// reused between uploads
+};
+
+
+#endif // !INSTANCEBUFFER_H
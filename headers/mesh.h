@@ -0,0 +1,48 @@
+#ifndef MESH_H
+#define MESH_H
+
+// STL
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+// Project
+#include "bounds.h"
+
+/*
+* common interface of the drawable primitives, so draws of different
+* mesh types can be queued and sorted together
+*/
+class Mesh
+{
+public:
+	virtual ~Mesh() {}
+
+	virtual void render() const = 0;
+	virtual void renderInstanced(const glm::mat4* models, int count) = 0;	// one draw for all model matrices
+	virtual void deleteVBO() = 0;
+
+	// VAO name, doubles as a small integer identifying the mesh
+	virtual unsigned int vertexArray() const = 0;
+
+	// front faces are counter-clockwise and back faces are culled, unless the
+	// mesh is open and its inside can be seen
+	bool isDoubleSided() const { return doubleSided; }
+	void setDoubleSided(bool doubleSided) { this->doubleSided = doubleSided; }
+
+	// object-space bounding box and sphere, filled in by the constructor
+	const Bounds& bounds() const { return localBounds; }
+
+	// coarse object-space triangles, three vertices each, for the software occlusion
+	// rasterizer. counter-clockwise faces hide what is behind them, and must be
+	// covered by the mesh from every side they are seen, so they never hide more
+	virtual void occluderTriangles(std::vector<glm::vec3>& triangles) const = 0;
+
+protected:
+	bool doubleSided = false;
+	Bounds localBounds;
+};
+
+
+#endif // !MESH_H
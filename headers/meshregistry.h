@@ -0,0 +1,30 @@
+#ifndef MESHREGISTRY_H
+#define MESHREGISTRY_H
+
+// STL
+#include <memory>
+
+// Project
+#include "cylinder.h"
+#include "plane.h"
+
+/*
+* hands out shared meshes keyed by their constructor parameters. asking for a mesh
+* that is already alive returns the existing VAO/VBO instead of building a new one;
+* the GPU buffers are deleted when the last handle to them is released.
+*
+* like every other GL object these must be created and released on the thread that
+* owns the GL context.
+*/
+class MeshRegistry
+{
+public:
+	static std::shared_ptr<Cylinder> cylinder(float topRadius, float bottomRadius, int numSlices, float height, bool topCircle, bool bottomCircle);
+	static std::shared_ptr<Plane> plane(float x, float z);
+
+	// number of distinct meshes currently alive
+	static int liveMeshes();
+};
+
+
+#endif // !MESHREGISTRY_H
@@ -0,0 +1,37 @@
+#ifndef NORMALMATRIX_H
+#define NORMALMATRIX_H
+
+// STL
+#include <cmath>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+/*
+* returns the matrix that transforms normals for the given model matrix.
+* shader.frag normalizes the interpolated normal, so when the model only rotates,
+* translates and scales uniformly its upper 3x3 already points normals the right
+* way and the inverse is skipped entirely.
+*/
+inline glm::mat3 computeNormalMatrix(const glm::mat4& model)
+{
+	const glm::mat3 linear(model);
+	const float xx = glm::dot(linear[0], linear[0]);
+	const float yy = glm::dot(linear[1], linear[1]);
+	const float zz = glm::dot(linear[2], linear[2]);
+	const float tolerance = 1e-4f * (xx + yy + zz);
+
+	// columns orthogonal and of equal length: rotation times uniform scale
+	if (std::fabs(xx - yy) <= tolerance && std::fabs(xx - zz) <= tolerance &&
+		std::fabs(glm::dot(linear[0], linear[1])) <= tolerance &&
+		std::fabs(glm::dot(linear[0], linear[2])) <= tolerance &&
+		std::fabs(glm::dot(linear[1], linear[2])) <= tolerance)
+	{
+		return linear;
+	}
+
+	return glm::transpose(glm::inverse(linear));
+}
+
+
+#endif // !NORMALMATRIX_H
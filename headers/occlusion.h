@@ -0,0 +1,64 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+// STL
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+// Project
+#include "shader.h"
+#include "bounds.h"
+
+/*
+* hardware occlusion culling with one GL_ANY_SAMPLES_PASSED query per object.
+*
+* after the visible objects are drawn, each object's bounding box is rasterized
+* against the depth buffer with all writes off. the results are collected at the
+* start of the next frame, and only those already available, so the CPU never waits
+* for the GPU. objects whose last result was "no samples" are left out of the main
+* pass and drawn under conditional rendering on their latest query instead, which
+* lets the GPU skip them without a readback while still catching objects that come
+* back into view.
+*/
+class OcclusionCuller
+{
+public:
+	OcclusionCuller();
+
+	// one query per object, object indices run from 0 to count - 1
+	void resize(unsigned int count);
+
+	// reads the results of earlier queries that are ready, without blocking
+	void collectResults();
+	// last known result, false until a query has come back
+	bool isOccluded(unsigned int object) const { return occluded[object] != 0; }
+	// forgets a result, e.g. when the camera is inside the object's box
+	void markVisible(unsigned int object) { occluded[object] = 0; }
+
+	// set up and restore GL state around a batch of issueQuery() calls
+	void beginQueries();
+	void endQueries();
+	// draws the box under the object's query, skipped while the previous one is in flight
+	void issueQuery(unsigned int object, const Bounds& worldBounds);
+	// query for conditional rendering, 0 if none was ever issued for the object
+	unsigned int query(unsigned int object) const;
+
+	void destroy();
+
+private:
+	Shader boxShader;
+	Shader::Uniform boxCenter;
+	Shader::Uniform boxExtents;
+
+	unsigned int VAO, VBO, EBO;		// unit cube
+
+	std::vector<unsigned int> queries;
+	std::vector<unsigned char> pending;		// issued, result not read yet
+	std::vector<unsigned char> issued;		// issued at least once
+	std::vector<unsigned char> occluded;
+};
+
+
+#endif // !OCCLUSION_H
@@ -5,7 +5,11 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 
-class Plane
+// Project
+#include "mesh.h"
+#include "instancebuffer.h"
+
+class Plane : public Mesh
 {
 public:
 	struct Vertex {
@@ -15,10 +19,18 @@ public:
 	};
 
 	Plane(float x, float z);
-	void render() const;
-	void deleteVBO();
+	void render() const override;
+	void renderInstanced(const glm::mat4* models, int count) override;	// one draw for all model matrices
+	void deleteVBO() override;
+	unsigned int vertexArray() const override { return VAO; }
+	void occluderTriangles(std::vector<glm::vec3>& triangles) const override;
 
 private:
+	InstanceBuffer instanceBuffer;	// per-instance matrices, attached to the VAO
+
+	float halfSizeX;
+	float halfSizeZ;
+
 	unsigned int VAO, VBO;
 };
 
@@ -0,0 +1,117 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+// STL
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+// Project
+#include "mesh.h"
+#include "frustum.h"
+#include "shader.h"
+#include "uniformbuffer.h"
+
+/*
+* collects the draws of a frame in any order, then sorts them by a packed 64-bit key
+* so draws sharing a program, texture, sampler and mesh run back to back and the state
+* changes between them are as few as possible.
+*
+* key layout by state, most significant first:
+*	program	10 bits
+*	texture	10 bits
+*	sampler	4 bits
+*	mesh	16 bits
+*	depth	24 bits, view distance quantized between the camera and the far plane
+*
+* front to back puts the depth on top so near occluders fill the depth buffer first
+* and early-z rejects the fragments behind them:
+*	depth	24 bits
+*	program	10 bits
+*	texture	10 bits
+*	sampler	4 bits
+*	mesh	16 bits
+*
+* draws may sample a layer of a texture array instead of a 2D texture. draws using
+* layers of the same array share the texture bits of the key, so nothing but the
+* layer uniform changes between them.
+*
+* before the first pass of a frame every instance is tested against the view frustum
+* in one SIMD batch, and instances outside of it are dropped.
+*/
+class RenderQueue
+{
+public:
+	enum SortMode
+	{
+		SORT_BY_STATE,			// fewest program/texture/mesh switches
+		SORT_FRONT_TO_BACK		// least overdraw
+	};
+
+	// non-instanced draws write their model/normal matrix to this ObjectData buffer
+	RenderQueue(UniformBuffer& objectBuffer);
+
+	// starts a new frame, the view matrix is used to compute each draw's depth and
+	// projection * view to cull against
+	void begin(const glm::mat4& projection, const glm::mat4& view, float farPlane);
+	// texture is a GL_TEXTURE_2D, or a GL_TEXTURE_2D_ARRAY when layer is not -1.
+	// sampler is bound with it, 0 reads it with the texture's own parameters
+	void submit(Shader& shader, unsigned int texture, Mesh& mesh, const glm::mat4& model, int layer = -1, unsigned int sampler = 0);
+	void submitInstanced(Shader& shader, unsigned int texture, Mesh& mesh, const glm::mat4* models, int count, int layer = -1, unsigned int sampler = 0);
+	// drawn under conditional rendering, only if the query found samples
+	void submitConditional(Shader& shader, unsigned int texture, Mesh& mesh, const glm::mat4& model, unsigned int query, int layer = -1, unsigned int sampler = 0);
+	// on by default, turn off when the caller has culled the draws already
+	void setFrustumCulling(bool enabled);
+
+	// sorts the queued draws and issues them
+	void execute(SortMode mode);
+	// issues the queued draws front to back with the given program and no textures,
+	// to lay down depth before execute()
+	void executeDepthOnly(Shader& depthShader);
+
+	static unsigned long long makeKey(SortMode mode, unsigned int program, unsigned int texture, unsigned int sampler,
+		unsigned int mesh, float depth);
+
+private:
+	struct Draw
+	{
+		Shader* shader;
+		Mesh* mesh;
+		unsigned int texture;
+		int layer;			// layer of an array texture, -1 for a 2D texture
+		unsigned int sampler;
+		float depth;		// nearest instance, as a fraction of the far plane
+		int firstModel;		// index into models
+		int numModels;
+		bool instanced;
+		unsigned int condition;		// occlusion query gating the draw, 0 for none
+	};
+
+	void add(Shader& shader, unsigned int texture, int layer, unsigned int sampler, Mesh& mesh, const glm::mat4* models, int count, bool instanced);
+	// drops instances outside the frustum, once per frame
+	void cull();
+	// fills order with draw indices sorted by key, LSD radix sort on bytes
+	void sort(SortMode mode);
+	// writes the object data of non-instanced draws and renders the mesh
+	void issue(const Draw& draw, Shader& shader, Shader::Uniform instancedUniform);
+
+	UniformBuffer& objectBuffer;
+	glm::mat4 view;
+	float farPlane;
+	Frustum frustum;
+	bool frustumCulling;
+	bool culled;
+
+	// reused between frames
+	std::vector<Draw> draws;
+	std::vector<glm::mat4> models;
+	BoundsArray bounds;						// world bounds, one per model
+	std::vector<unsigned char> visible;
+	std::vector<unsigned long long> keys;
+	std::vector<unsigned int> order;
+	std::vector<unsigned int> scratch;
+};
+
+
+#endif // !RENDERQUEUE_H
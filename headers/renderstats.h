@@ -0,0 +1,27 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+/*
+* counters collected while rendering, reset by the caller at the start of each frame
+*/
+struct RenderStats
+{
+	unsigned int drawCalls = 0;					// glDraw* calls issued by meshes
+	unsigned int uniformUploads = 0;			// glUniform* calls issued by Shader
+	unsigned int uniformUploadsSkipped = 0;		// uniform sets dropped because the value was unchanged
+	unsigned int uniformBufferUpdates = 0;		// uniform block writes
+	unsigned int stateChanges = 0;				// binds/enables issued by GLState
+	unsigned int stateChangesFiltered = 0;		// binds/enables dropped as redundant
+	unsigned int objectsTested = 0;				// instances tested against the view frustum
+	unsigned int objectsCulled = 0;				// instances outside of it, never drawn
+	unsigned int occlusionQueries = 0;			// bounding boxes drawn under a query
+	unsigned int objectsOccluded = 0;			// held back because their last query found no samples
+
+	void reset() { *this = RenderStats(); }
+};
+
+// shared by every mesh, defined in scene.cpp
+extern RenderStats renderStats;
+
+
+#endif // !RENDERSTATS_H
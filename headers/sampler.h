@@ -0,0 +1,50 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+// STL
+#include <memory>
+
+/*
+* a GL sampler object, how a texture is filtered and wrapped. bound to a texture
+* unit it overrides the texture's own parameters, so one setting serves every
+* texture a material uses and the same texture can be read differently.
+*
+* samplers are shared by their settings: asking for one that is already alive
+* returns the existing object, and the GL object is deleted with the last handle,
+* as MeshRegistry does for meshes. GL thread only.
+*/
+class Sampler
+{
+public:
+	// how minified texels are filtered, magnification is always linear
+	enum MipFilter
+	{
+		MIP_NONE,		// bilinear in level 0 only, the mip chain is never read
+		MIP_NEAREST,	// bilinear in the nearest level
+		MIP_LINEAR		// trilinear, blends the two nearest levels
+	};
+
+	// anisotropy above 1 needs GL_EXT_texture_filter_anisotropic and is clamped to
+	// what the context supports. textures wrap with GL_REPEAT
+	static std::shared_ptr<Sampler> get(MipFilter mipFilter, float anisotropy);
+	// largest anisotropy the context supports, 1 without the extension
+	static float maxAnisotropy();
+
+	~Sampler();
+
+	unsigned int id() const { return samplerID; }
+	MipFilter mipFilter() const { return filter; }
+	float anisotropy() const { return maxSamples; }
+
+private:
+	Sampler(MipFilter mipFilter, float anisotropy);
+	Sampler(const Sampler&) = delete;
+	Sampler& operator=(const Sampler&) = delete;
+
+	unsigned int samplerID;
+	MipFilter filter;
+	float maxSamples;
+};
+
+
+#endif // !SAMPLER_H
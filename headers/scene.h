@@ -0,0 +1,171 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+// STL
+#include <memory>
+#include <vector>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+// project headers 
+#include <shader.h>
+#include <cylinder.h>
+#include <plane.h>
+#include <camera.h>
+#include <uniformbuffer.h>
+#include <renderqueue.h>
+#include <bvh.h>
+#include <occlusion.h>
+#include <depthrasterizer.h>
+#include <texturearray.h>
+#include <textureloader.h>
+#include <sampler.h>
+
+/*
+* owns the shader, meshes and textures of the table scene and draws one frame of it.
+* shared by the interactive window in main.cpp and the headless benchmark
+*/
+class Scene
+{
+public:
+	// how props hidden behind others are found
+	enum OcclusionMode
+	{
+		OCCLUSION_OFF,
+		OCCLUSION_QUERIES,		// GPU queries, results used a frame late
+		OCCLUSION_SOFTWARE		// CPU depth buffer of the big props, same frame
+	};
+
+	// packTextures puts all textures in the layers of one texture array, so props
+	// only differ by a layer uniform and no texture is bound between draws.
+	// compression block compresses them when their caches are built
+	explicit Scene(bool packTextures = true, TextureLoader::Compression compression = TextureLoader::COMPRESSION_HIGH);
+	// viewportHeight is the framebuffer height in pixels, it sets the texture sizes needed
+	void render(Camera& camera, float aspectRatio, int viewportHeight);
+	// textures load in the background, this blocks until they are all in
+	void finishLoading();
+	bool texturesLoaded();
+	// bytes of the larger mip levels streamed in per frame, 0 for no limit
+	void setTextureStreamBudget(size_t bytesPerFrame);
+	// bytes of texture data kept in GL
+	size_t textureMemory() const;
+	// timing of each texture load, in the order they were made
+	const std::vector<TextureLoader::LoadStats>& textureLoadStats() const { return textureLoader.loadStats(); }
+	// memory the textures may take, 0 for no limit. the levels too fine for the
+	// size the props are drawn at are dropped first
+	void setTextureMemoryBudget(size_t bytes);
+	void destroy();
+
+	// how the textures are filtered when minified. every material uses the mip
+	// filter, the table, mostly seen at a grazing angle, also the anisotropy
+	void setTextureFiltering(Sampler::MipFilter mipFilter, float anisotropy);
+
+	// runtime switches for comparing overdraw strategies
+	void setSortMode(RenderQueue::SortMode mode);
+	void setDepthPrepass(bool enabled);
+	void setOcclusionMode(OcclusionMode mode);
+
+	// BVH queries over the props
+	int pick(const Camera& camera, float maxDistance) const;
+	const char* objectName(int object) const;
+	bool collides(const glm::vec3& position, float radius) const;
+
+private:
+	// frames between occlusion queries of a prop that was visible
+	static const unsigned int VISIBLE_QUERY_INTERVAL = 4;
+	// width and height of every layer of the packed textures
+	static const int TEXTURE_LAYER_SIZE = 1024;
+	// anisotropic samples for the table, clamped to what the context supports
+	static constexpr float DEFAULT_ANISOTROPY = 8.0f;
+
+	// the samplers the materials choose from
+	enum SamplerKind
+	{
+		SAMPLER_PROP,
+		SAMPLER_SURFACE,		// large flat surfaces, anisotropic
+		NUM_SAMPLERS
+	};
+
+	// a 2D texture, or a layer of the texture array, and the sampler reading it
+	struct SceneTexture
+	{
+		unsigned int name;
+		int layer;		// -1 for a 2D texture
+		SamplerKind sampler;
+	};
+
+	// a prop on the table, drawn with the scene shader
+	struct SceneObject
+	{
+		const char* name;
+		Mesh* mesh;
+		SceneTexture texture;
+		glm::mat4 model;
+		unsigned int batch;		// first object with the same mesh and texture
+		bool occluder;			// drawn into the software depth buffer
+	};
+
+	void loadTextures();
+	void requestTextureSizes(const Camera& camera, int viewportHeight);
+	void placeObjects();
+	void addObject(const char* name, Mesh& mesh, SceneTexture texture, const glm::mat4& model, bool occluder = false);
+	void submitBatched(std::vector<unsigned int>& objectList);
+	void issueOcclusionQueries(const std::vector<unsigned int>& objectList, const glm::vec3& cameraPosition, unsigned int interval);
+	static bool insideBounds(const glm::vec3& point, const Bounds& bounds);
+
+	Shader ourShader;
+	Shader depthShader;		// position only, for the depth pre-pass
+
+	// uniform blocks shared by all programs
+	UniformBuffer frameBuffer;
+	UniformBuffer objectBuffer;
+
+	// sorts the frame's draws to minimize state changes
+	RenderQueue queue;
+
+	// meshes, shared through the MeshRegistry
+	std::shared_ptr<Plane> plane;
+	std::shared_ptr<Cylinder> cornMiddle;
+	std::shared_ptr<Cylinder> cornEnd;
+	std::shared_ptr<Cylinder> skilletMain;
+	std::shared_ptr<Cylinder> rod;		// unit height, the skillet handle and the sausage
+	std::shared_ptr<Cylinder> burger;
+	std::shared_ptr<Cylinder> plate;
+
+	// textures
+	bool packTextures;
+	TextureLoader textureLoader;
+	TextureArray textureArray;
+	SceneTexture cornTexture;
+	SceneTexture tableTexture;
+	SceneTexture skilletTexture;
+	SceneTexture burgerTexture;
+	SceneTexture plateTexture;
+	std::shared_ptr<Sampler> samplers[NUM_SAMPLERS];
+
+	glm::vec3 lightPos;
+
+	RenderQueue::SortMode sortMode;
+	bool depthPrepass;
+	OcclusionMode occlusionMode;
+	unsigned int frameIndex;		// staggers the occlusion queries
+
+	// props and their world bounds, in the same order
+	std::vector<SceneObject> objects;
+	std::vector<Bounds> objectBounds;
+	BVH bvh;
+	OcclusionCuller occlusion;
+	DepthRasterizer rasterizer;
+	std::vector<glm::vec3> occluderTriangles;		// world space, for the rasterizer
+
+	// reused between frames
+	std::vector<unsigned int> visibleObjects;
+	std::vector<unsigned int> occludedObjects;
+	std::vector<unsigned int> occluderObjects;		// submitted while the rasterizer runs
+	std::vector<glm::mat4> instanceModels;
+	mutable std::vector<unsigned int> collisionHits;
+};
+
+
+#endif // !SCENE_H
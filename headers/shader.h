@@ -6,10 +6,13 @@
 // GLM headers 
 #include <glm/glm.hpp>
 
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 
 class Shader
 {
@@ -18,12 +21,21 @@ public:
 	// the program ID
 	unsigned int ID;
 
+	// handle to a uniform resolved once from the table built at link time
+	struct Uniform
+	{
+		int slot = -1;		// index into the uniform table, -1 if the program has no such uniform
+	};
+
 	// constructor reads and build the shader
 	Shader(const char* vertexPath, const char* fragmentPath);
 
 	// use/activate the shader
 	void use();
 
+	// looks up a uniform handle by name, without asking the driver
+	Uniform uniform(const std::string& name) const;
+
 	// utility uniform functions
 	void setBool(const std::string& name, bool value) const;
 	void setInt(const std::string& name, int value) const;
@@ -37,9 +49,36 @@ public:
 	void setMat2(const std::string& name, const glm::mat2& mat) const;
 	void setMat3(const std::string& name, const glm::mat3& mat) const;
 	void setMat4(const std::string& name, const glm::mat4& mat) const;
+
+	// uniform functions taking pre-resolved handles, for the render loop.
+	// values equal to the last one set are not uploaded again
+	void setBool(Uniform uniform, bool value) const;
+	void setInt(Uniform uniform, int value) const;
+	void setFloat(Uniform uniform, float value) const;
+	void setVec2(Uniform uniform, const glm::vec2& value) const;
+	void setVec3(Uniform uniform, const glm::vec3& value) const;
+	void setVec4(Uniform uniform, const glm::vec4& value) const;
+	void setMat2(Uniform uniform, const glm::mat2& mat) const;
+	void setMat3(Uniform uniform, const glm::mat3& mat) const;
+	void setMat4(Uniform uniform, const glm::mat4& mat) const;
 	
 private:
+	// an active uniform and the last value uploaded to it
+	struct UniformState
+	{
+		int location;
+		bool hasValue;
+		unsigned char value[sizeof(glm::mat4)];
+	};
+
 	void checkCompileErrors(unsigned int shader, std::string type);
+	void buildUniformTable();
+	void bindUniformBlocks();
+	// returns true and remembers the value if it differs from what the uniform holds
+	bool changed(Uniform uniform, const void* value, size_t size) const;
+
+	std::unordered_map<std::string, int> uniformSlots;		// name -> index into uniforms
+	mutable std::vector<UniformState> uniforms;
 };
 
 #endif
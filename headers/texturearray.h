@@ -0,0 +1,37 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+/*
+* one GL_TEXTURE_2D_ARRAY holding several images, so draws with different images
+* share a single texture binding and only a layer index changes.
+*
+* all layers of an array have the same size, so every image is resampled to
+* layerSize x layerSize with a box filter. texture coordinates stay the same,
+* they address the whole image whatever its size was.
+*/
+class TextureArray
+{
+public:
+	TextureArray();
+
+	// allocates the layers and all their mip levels, RGB8 or BC1, and fills them with
+	// a grey placeholder until images are uploaded, e.g. by TextureLoader::loadLayer()
+	void create(int numLayers, int layerSize, bool compressed);
+	void destroy();
+
+	unsigned int texture() const { return textureID; }
+	int layerCount() const { return numLayers; }
+	int layerSize() const { return size; }
+
+	// averages the source pixels under each destination pixel, RGB only
+	static void resample(const unsigned char* source, int sourceWidth, int sourceHeight,
+		unsigned char* destination, int destinationSize);
+
+private:
+	unsigned int textureID;
+	int numLayers;
+	int size;
+};
+
+
+#endif // !TEXTUREARRAY_H
@@ -0,0 +1,121 @@
+#ifndef TEXTUREFILE_H
+#define TEXTUREFILE_H
+
+// STL
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+* binary texture container with every mip level precomputed, so a cached texture
+* is neither decoded nor run through glGenerateMipmap at startup.
+*
+* layout: a fixed size header, then the levels from largest to smallest, each
+* tightly packed (no row padding) as 1, 3 or 4 bytes per pixel or in 4x4 blocks
+* (see BlockEncoder). the file is memory mapped and GL reads the levels straight
+* out of the mapping, so nothing is copied on the way and every process showing
+* the same texture shares its pages through the page cache.
+*
+* the header records the size and modification time of the source image. a cache
+* older or newer than its source counts as stale, one whose source is missing is
+* used as it is. it also keeps a hash of the source's bytes, so textures can be
+* matched by content without reading the image again.
+*/
+class TextureFile
+{
+public:
+	enum Format
+	{
+		FORMAT_RGB8 = 1,	// 3 bytes per pixel
+		FORMAT_BC1 = 2,		// S3TC DXT1, 8 bytes per 4x4 block
+		FORMAT_RGTC1 = 3,	// one channel, 8 bytes per 4x4 block
+		FORMAT_R8 = 4,		// 1 byte per pixel
+		FORMAT_RGBA8 = 5	// 4 bytes per pixel
+	};
+
+	static const int MAX_LEVELS = 16;
+
+	struct Level
+	{
+		int width;
+		int height;
+		const unsigned char* data;
+		size_t size;
+	};
+
+	TextureFile();
+	~TextureFile();
+
+	// maps the cache file, false if it is missing, unreadable or stale against sourcePath
+	bool open(const char* path, const char* sourcePath);
+	void close();
+	// reads the whole mapping in on the calling thread, so the upload calls that read
+	// the levels later do not stop on page faults
+	void prefault() const;
+
+	Format format() const { return (Format)header.format; }
+	int levelCount() const { return (int)levels.size(); }
+	const Level& level(int index) const { return levels[index]; }
+
+	// writes the levels to path through a temporary file, so readers never see half a file
+	static bool write(const char* path, const char* sourcePath, unsigned long long sourceHash,
+		Format format, const std::vector<Level>& levels);
+	// reads only the header of the cache at path for the hash of its source, false
+	// if it is missing or stale against sourcePath
+	static bool readSourceHash(const char* path, const char* sourcePath, unsigned long long& hash);
+	// hash of a file's bytes, false if it cannot be read
+	static bool hashFile(const char* path, unsigned long long& hash);
+
+	// bytes of one level
+	static size_t levelSize(Format format, int width, int height);
+	// true for the formats stored in 4x4 blocks
+	static bool blockCompressed(Format format) { return format == FORMAT_BC1 || format == FORMAT_RGTC1; }
+	// channels a pixel of the format holds, also its bytes in the uncompressed formats
+	static int channels(Format format);
+
+	// fills storage with the full mip chain of an image with 1 to 4 channels down to
+	// 1x1, each level a 2x2 box filter of the one above, and points levels into it
+	static void buildMipmaps(const unsigned char* pixels, int width, int height, int channels,
+		std::vector<unsigned char>& storage, std::vector<Level>& levels);
+
+	// where the cache of an image lives, size is the layer size it was resampled to or 0
+	static std::string cachePath(const char* sourcePath, int size);
+
+private:
+	struct Header
+	{
+		char magic[4];
+		unsigned int version;
+		unsigned int format;
+		unsigned int numLevels;
+		unsigned int width;
+		unsigned int height;
+		unsigned long long sourceSize;
+		long long sourceTime;		// modification time in nanoseconds
+		unsigned long long sourceHash;
+		unsigned long long levelOffsets[MAX_LEVELS];	// from the start of the file
+		unsigned long long levelSizes[MAX_LEVELS];
+	};
+
+	// size and modification time (in nanoseconds) of a file, false if it does not exist
+	static bool fileStamp(const char* path, unsigned long long& size, long long& time);
+	// false if the header is not a valid one, or was written for another version of the source
+	static bool validHeader(const Header& header, const char* sourcePath);
+
+	// non-copyable, owns the mapping
+	TextureFile(const TextureFile&);
+	TextureFile& operator=(const TextureFile&);
+
+	Header header;
+	std::vector<Level> levels;
+
+	const unsigned char* mapping;
+	size_t mappingSize;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+};
+
+
+#endif // !TEXTUREFILE_H
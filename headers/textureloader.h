@@ -0,0 +1,250 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+// STL
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Project
+#include "texturefile.h"
+#include "blockencoder.h"
+
+class TextureArray;
+
+/*
+* loads image textures without holding up the first frame, and owns them.
+*
+* a 2D texture is loaded once per image: loading a path again, or another file
+* with the same bytes, returns the texture already made for it. the content hash
+* is read from the image's cache header. an image without a cache yet is hashed
+* on the pool, so it can only be matched by content once it has arrived.
+*
+* a load returns at once and the texture shows a grey placeholder. worker threads
+* look for a TextureFile cache of each image and map it, or decode the image (and
+* resample those meant for a texture array layer), build its mip chain and write
+* the cache for the next start. update(), called by the render loop on the GL
+* thread, streams the finished ones in: the small levels at the end of the mip
+* chain go up at once, the larger ones over the following frames within a byte
+* budget per frame, a big level in bands of rows. until a level is complete the
+* texture's GL_TEXTURE_BASE_LEVEL keeps sampling on the finest one that is.
+*
+* loaded textures stay managed against a memory budget. the renderer reports the
+* size each texture is drawn at with requireSize(); while the textures would take
+* more than the budget, the finest level of the largest is dropped, first those
+* finer than needed for their size on screen, then the rest. a dropped level is
+* redefined empty below the base level, and streamed in again from the cache once
+* there is room.
+*
+* all of the CPU work runs on the pool. cached levels go to GL straight from the
+* file mapping; freshly decoded ones are copied into a pixel buffer object once
+* and the driver carries out the transfer after the call returns.
+*
+* a 2D texture keeps the channels of its image: R8 for one channel images (read as
+* grey), RGBA8 for those with alpha and RGB8 for the rest. array layers are RGB8.
+* with compression on, caches are built block compressed: BC1 for colour images
+* and array layers, RGTC1 for one channel 2D images. images with alpha stay
+* uncompressed, BC1 would lose it. a cache in the other kind of format is rebuilt.
+*
+* where the context has glTexStorage2D, 2D textures loaded while there is no
+* memory budget get immutable storage for their whole mip chain. they are never
+* dropped, a memory budget set later leaves them whole.
+*/
+class TextureLoader
+{
+public:
+	enum Compression
+	{
+		COMPRESSION_OFF,		// RGB8 / R8 / RGBA8, 1 to 4 bytes per texel
+		COMPRESSION_FAST,		// BC1 / RGTC1, half a byte per texel
+		COMPRESSION_HIGH		// same formats, refined endpoints
+	};
+
+	// what one load cost, times in milliseconds from the load call
+	struct LoadStats
+	{
+		std::string path;
+		bool cached;				// read from its TextureFile, not decoded
+		bool shared;				// returned a texture loaded before, nothing else is set
+		double decodeTime;			// on the pool, reading the cache or decoding the image
+		double uploadTime;			// on the GL thread, in the upload calls
+		double firstLevelsTime;		// until the small levels were in and it could be drawn
+		double completeTime;		// until all levels the budget keeps were in, 0 before
+		size_t bytes;				// uploaded for it
+	};
+
+	// numThreads 0 uses one per hardware thread
+	explicit TextureLoader(unsigned int numThreads = 0);
+	~TextureLoader();
+
+	// applies to the loads queued after it, GL thread only. falls back to
+	// COMPRESSION_OFF when the context lacks GL_EXT_texture_compression_s3tc
+	void setCompression(Compression compression);
+	Compression compression() const { return compressionMode; }
+
+	// returns a GL_TEXTURE_2D with a 1x1 placeholder, replaced by the image once it
+	// has been decoded and update() has uploaded it. the same texture for the same
+	// image; it stays valid until destroy()
+	unsigned int load2D(const char* path);
+	// decodes the image into a layer of the array, resampled to its layer size
+	void loadLayer(const TextureArray& array, int layer, const char* path);
+
+	// bytes of the larger mip levels update() uploads per call, 0 for no limit.
+	// the levels up to TAIL_SIZE are uploaded as soon as an image is decoded
+	void setStreamBudget(size_t bytesPerFrame) { streamBudget = bytesPerFrame; }
+
+	// bytes the loaded textures may take in all, 0 for no limit
+	void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+	// the texture is drawn this frame at about this many pixels across. the
+	// largest size reported before update() decides the levels it needs
+	void requireSize(unsigned int texture, float pixels);
+
+	// uploads the images decoded since the last call and continues streaming the
+	// levels of earlier ones, GL thread only
+	void update();
+	// true once every queued image is decoded and the levels the budget keeps are
+	// uploaded, as of the last update(). GL thread only
+	bool idle();
+	// waits for all queued images and uploads them
+	void finish();
+	// drops the queued images and deletes the 2D textures
+	void destroy();
+
+	// texture data handed to GL so far, all levels
+	size_t bytesUploaded() const { return uploadedBytes; }
+	// bytes of the levels the loaded textures currently keep in GL
+	size_t residentBytes() const;
+	// one entry per load call, in order
+	const std::vector<LoadStats>& loadStats() const { return stats; }
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Job
+	{
+		const char* path;
+		unsigned int texture;
+		int layer;			// -1 for a 2D texture
+		int layerCount;
+		int layerSize;
+		Compression compression;
+		bool hashed;		// sourceHash is known, decode() fills in the result's copy if not
+		unsigned long long sourceHash;
+		size_t load;		// index of its LoadStats
+		Clock::time_point start;
+	};
+
+	struct Result
+	{
+		Job job;
+		bool cached;
+		double decodeTime;
+		TextureFile::Format format;
+		std::vector<TextureFile::Level> levels;		// empty if the image failed to load
+		std::shared_ptr<TextureFile> file;			// mapped cache the levels point into, or
+		std::vector<unsigned char> pixels;			// the decoded mip chain they point into
+	};
+
+	void workerLoop();
+	// reads the cache of the job's image, or decodes it and writes the cache
+	void decode(const Job& job, Result& result);
+	// replaces the levels with their block compressed encoding
+	static void compress(Result& result, TextureFile::Format format, BlockEncoder::Quality quality);
+	// the format the job's texture is built in, for an image with this many channels
+	static TextureFile::Format chooseFormat(const Job& job, int channels);
+	// GL internal format and pixel format of the levels
+	static unsigned int internalFormat(TextureFile::Format format);
+	static unsigned int pixelFormat(TextureFile::Format format);
+	// queues the job, timed from now
+	void queue(Job& job);
+
+	// a 2D texture handed out by load2D()
+	struct Texture
+	{
+		std::string path;
+		unsigned long long sourceHash;
+		bool hashed;
+		unsigned int texture;
+		size_t load;		// the load that made it
+	};
+
+	// a GL texture with at least one image in: a 2D texture, or an array whose
+	// layers all share the levels kept
+	struct Residency
+	{
+		unsigned int texture;
+		unsigned int target;
+		int layerCount;		// 1 for a 2D texture
+		int width;			// of level 0
+		int height;
+		int topLevel;		// finest level allocated in GL
+		int tailLevel;		// the levels from here on are never dropped
+		int baseLevel;		// GL_TEXTURE_BASE_LEVEL last set
+		float screenSize;	// largest requireSize() since the last update
+		bool immutable;		// allocated whole with glTexStorage2D, never dropped
+		TextureFile::Format format;
+		std::vector<size_t> levelSizes;		// bytes of each level, all layers
+	};
+
+	// a decoded image, its levels going up to GL smallest first
+	struct Image
+	{
+		Result result;
+		size_t residency;
+		int nextLevel;		// finest level not yet complete, topLevel - 1 once all are
+		int nextRow;		// rows of it uploaded so far, in blocks for compressed formats
+	};
+
+	// levels no larger than this are uploaded without waiting for the budget
+	static const int TAIL_SIZE = 64;
+	static const size_t DEFAULT_STREAM_BUDGET = 4 * 1024 * 1024;
+
+	// takes in the new images, fits the textures to the memory budget and uploads
+	// from the images until about budget bytes have been spent
+	void stream(size_t budget);
+	// continues the image's finest missing level, at least one row of it
+	size_t streamLevel(Image& image, size_t budget);
+	// picks the finest level of every texture for the memory budget
+	void fitBudget();
+	// coarsest level that still has screenSize pixels across
+	static int neededLevel(const Residency& residency);
+	// allocates or drops levels so topLevel is the finest one in GL
+	void setTopLevel(size_t residency, int topLevel);
+	// hands rows [firstRow, firstRow + rows) of a level to GL
+	void upload(const Result& result, int level, int firstRow, int rows);
+	// milliseconds since the job's load call
+	static double millisecondsSince(const Job& job);
+	// rows of a level as they are uploaded, and the bytes in each
+	static int rowCount(TextureFile::Format format, const TextureFile::Level& level);
+	static size_t rowSize(TextureFile::Format format, const TextureFile::Level& level);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable jobCondition;
+	std::condition_variable resultCondition;
+	std::deque<Job> jobs;
+	std::vector<Result> results;
+	unsigned int pending;		// queued or decoding, not yet in results
+	bool quit;
+
+	Compression compressionMode;
+	size_t uploadedBytes;
+	size_t streamBudget;
+	size_t memoryBudget;
+
+	unsigned int PBO;
+	std::vector<Result> ready;		// reused by update()
+	std::vector<Image> images;		// in the order they finished decoding
+	std::vector<Residency> residency;
+	std::vector<int> topLevels;		// reused by fitBudget()
+	std::vector<Texture> textures;
+	std::vector<LoadStats> stats;
+};
+
+
+#endif // !TEXTURELOADER_H
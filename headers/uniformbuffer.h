@@ -0,0 +1,54 @@
+#ifndef UNIFORMBUFFER_H
+#define UNIFORMBUFFER_H
+
+// STL
+#include <cstddef>
+
+// GLM headers 
+#include <glm/glm.hpp>
+
+/*
+* binding points shared by every Shader program. Shader connects blocks with these
+* names to their binding point after linking
+*/
+enum UniformBlockBinding
+{
+	FRAME_BLOCK_BINDING = 0,	// "FrameData", camera and light, written once per frame
+	OBJECT_BLOCK_BINDING = 1	// "ObjectData", model and normal matrix, written per draw
+};
+
+// std140 layout of the FrameData block in shader.vert / shader.frag
+struct FrameData
+{
+	glm::mat4 projection;
+	glm::mat4 view;
+	glm::vec4 viewPos;			// vec3 in GLSL, padded to 16 bytes
+	glm::vec4 lightPos;
+	glm::vec4 lightColor;
+};
+
+// std140 layout of the ObjectData block in shader.vert
+struct ObjectData
+{
+	glm::mat4 model;
+	glm::vec4 normalMatrix[3];	// mat3 in GLSL, each column padded to 16 bytes
+};
+
+/*
+* a uniform buffer object permanently bound to one of the binding points above
+*/
+class UniformBuffer
+{
+public:
+	UniformBuffer(unsigned int binding, size_t size);
+	// replaces the whole buffer contents with one write
+	void update(const void* data);
+	void deleteBuffer();
+
+private:
+	unsigned int UBO;
+	size_t size;
+};
+
+
+#endif // !UNIFORMBUFFER_H
@@ -0,0 +1,23 @@
+#ifndef UNITCIRCLE_H
+#define UNITCIRCLE_H
+
+/*
+* sines and cosines of numSlices + 1 evenly spaced angles around the unit circle,
+* starting at angle 0. the last entry repeats the first so rings close on themselves.
+*
+* tables are shared process-wide and never freed: every revolution-surface mesh
+* with the same slice count reads the same table instead of recomputing it.
+*/
+class UnitCircle
+{
+public:
+	// returns the table for the given slice count, building it on first use. thread-safe
+	static const UnitCircle& get(int numSlices);
+
+	int numSlices;
+	const float* sines;
+	const float* cosines;
+};
+
+
+#endif // !UNITCIRCLE_H
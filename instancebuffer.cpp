@@ -0,0 +1,62 @@
+// GLAD header
+#include <glad/glad.h>	
+
+// Project
+#include "instancebuffer.h"
+#include "normalmatrix.h"
+
+void InstanceBuffer::attach()
+{
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	// always keep one identity instance so non-instanced draws never read past the buffer
+	Instance identity = { glm::mat4(1.0f), glm::mat3(1.0f) };
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Instance), &identity, GL_STREAM_DRAW);
+	capacity = 1;
+
+	// model matrix, one column per attribute location
+	for (int column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offsetof(Instance, model) + sizeof(glm::vec4) * column));
+		glVertexAttribDivisor(3 + column, 1);
+	}
+
+	// normal matrix
+	for (int column = 0; column < 3; column++)
+	{
+		glEnableVertexAttribArray(7 + column);
+		glVertexAttribPointer(7 + column, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offsetof(Instance, normalMatrix) + sizeof(glm::vec3) * column));
+		glVertexAttribDivisor(7 + column, 1);
+	}
+}
+
+void InstanceBuffer::upload(const glm::mat4* models, int count)
+{
+	instances.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		instances[i].model = models[i];
+		instances[i].normalMatrix = computeNormalMatrix(models[i]);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (count > capacity)
+	{
+		// grow the buffer
+		capacity = count;
+		glBufferData(GL_ARRAY_BUFFER, count * sizeof(Instance), instances.data(), GL_STREAM_DRAW);
+	}
+	else
+	{
+		// orphan the old contents so the driver does not wait on draws still reading them
+		glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Instance), instances.data());
+	}
+}
+
+void InstanceBuffer::deleteVBO()
+{
+	glDeleteBuffers(1, &VBO);
+}
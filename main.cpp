@@ -11,14 +11,10 @@
 #include <glm/gtc/type_ptr.hpp>
 
 // project headers 
-#include <shader.h>
-#include <cylinder.h>
-#include <plane.h>
 #include <camera.h>
-
-// stb_image headers for image textures
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include <scene.h>
+#include <glstate.h>
+#include <glextensions.h>
 
 /*
 user-defined functions to create a GLFW window,
@@ -26,7 +22,7 @@ resize the window, and processing user input
 */
 bool initializeWindow(GLFWwindow** window);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window);
+void processInput(GLFWwindow* window, Scene& scene);
 
 /*
 * user-defined functions for using mouse and scroll wheel for camera movement
@@ -62,12 +58,6 @@ float lastY = (float)HEIGHT / 2.0;
 float deltaTime = 0.0f;		// time between frames
 float lastFrame = 0.0f;		// for calculating delta in loop
 
-/*
-* LIGHT  POSITIONS
-*/
-glm::vec3 lightPos = glm::vec3(-5.0f, 2.0f, 0.0f);
-
-
 /*
 * MAIN PROGRAM
 */
@@ -81,147 +71,9 @@ int main()
 
 
 	/*
-	* CREATE SHADER PROGRAMS
-	*/
-	Shader ourShader("shader.vert", "shader.frag");			
-
-
-	/*
-	* CREATE OBJECTS
+	* CREATE SCENE
 	*/
-	Plane plane(1.0f, 1.0f);
-	Cylinder cornMiddle(1.0f, 1.0f, 100, 3.0f, true, true);
-	Cylinder cornEnd(0.6f, 1.0f, 100, 2.0f, true, true);
-	Cylinder skilletMain(1.0f, 0.8f, 100, 1.0f, false, true);
-	Cylinder skilletHandle(0.5f, 0.5f, 50, 0.5f, true, true);
-	Cylinder burger(1.0f, 1.0f, 50, 0.25f, true, true);
-	Cylinder plate(1.0f, 0.8f, 50, 0.1f, false, true);
-	Cylinder sausage(0.5f, 0.5f, 50, 3.0f, true, true);
-
-
-	/*
-	* LOAD TEXTURES
-	*/
-	// corn texture
-	unsigned int cornTexture;
-	glGenTextures(1, &cornTexture);
-	glBindTexture(GL_TEXTURE_2D, cornTexture);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true);							// tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char* data = stbi_load("corn.jpg", &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-
-	// table texture
-	unsigned int tableTexture;
-	glGenTextures(1, &tableTexture);
-	glBindTexture(GL_TEXTURE_2D, tableTexture);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	stbi_set_flip_vertically_on_load(true);							// tell stb_image.h to flip loaded texture's on the y-axis.
-	data = stbi_load("table.jpg", &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-
-	// skillet texture
-	unsigned int skilletTexture;
-	glGenTextures(1, &skilletTexture);
-	glBindTexture(GL_TEXTURE_2D, skilletTexture);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	stbi_set_flip_vertically_on_load(true);							// tell stb_image.h to flip loaded texture's on the y-axis.
-	data = stbi_load("skillet.jpg", &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-
-	// burger texture
-	unsigned int burgerTexture;
-	glGenTextures(1, &burgerTexture);
-	glBindTexture(GL_TEXTURE_2D, burgerTexture);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	stbi_set_flip_vertically_on_load(true);							// tell stb_image.h to flip loaded texture's on the y-axis.
-	data = stbi_load("burger.jpg", &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-
-	// plate texture
-	unsigned int plateTexture;
-	glGenTextures(1, &plateTexture);
-	glBindTexture(GL_TEXTURE_2D, plateTexture);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	stbi_set_flip_vertically_on_load(true);							// tell stb_image.h to flip loaded texture's on the y-axis.
-	data = stbi_load("plate.jpg", &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
+	Scene scene;
 
 
 	/*
@@ -234,164 +86,19 @@ int main()
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		processInput(window);				// process and apply user input
-
-		// enable z-depth and set background color
-		glEnable(GL_DEPTH_TEST);
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		/*
-		* SET LIGHT ATTRIBUTES
-		*/
-		ourShader.use();
-		ourShader.setVec3("viewPos", camera.Position);
-		ourShader.setVec3("lightPos", lightPos);
-		ourShader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 0.95f));
-
-
-		/*
-		* PROJECTION AND CAMERA
-		*/
-
-		// set projection vector and pass to shader
-		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
-		ourShader.setMat4("projection", projection);
-		// camera/view transformation
-		glm::mat4 view = camera.GetViewMatrix();
-		ourShader.setMat4("view", view);
-		 
-
-		/*
-		* PLANE TRANSFORMATIONS
-		*/
-
-		// set ashpalt texture for plane
-		glBindTexture(GL_TEXTURE_2D, tableTexture);
-		ourShader.setInt("ourTexture", 0);
-
-		glm::mat4 scale = glm::scale(glm::vec3(5.0f, 5.0f, 3.5f));
-		glm::mat4 rotation = glm::rotate(glm::radians(0.0f), glm::vec3(0.0, 1.0f, 0.0f));
-		glm::mat4 translate = glm::translate(glm::vec3(0.0f, 0.0f, 0.0f));
-		glm::mat4 model = translate * rotation * scale;
-		// model uniform data
-		ourShader.setMat4("model", model);
-		plane.render();
-
-
-		/*
-		* SKILLET
-		*/
-		// set metal texture for skillet
-		glBindTexture(GL_TEXTURE_2D, skilletTexture);
-		ourShader.setInt("ourTexture", 0);
-
-		scale = glm::scale(glm::vec3(1.5f, 0.5f, 1.5f));
-		rotation = glm::rotate(glm::radians(0.0f), glm::vec3(0.0, 0.0f, 1.0f));
-		translate = glm::translate(glm::vec3(-2.0f, 0.26f, 0.0f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		skilletMain.render();
-
-		scale = glm::scale(glm::vec3(0.3f, 2.75f, 0.1f));
-		rotation = glm::rotate(glm::radians(90.0f), glm::vec3(1.0, 0.0f, 0.0f));
-		translate = glm::translate(glm::vec3(-2.0f, 0.4f, 2.12f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		skilletHandle.render();
-
-
-		/*
-		* PLATE
-		*/
-		glBindTexture(GL_TEXTURE_2D, plateTexture);
-		ourShader.setInt("ourTexture", 0);
-
-		scale = glm::scale(glm::vec3(1.0f, 1.0f, 1.0f));
-		rotation = glm::rotate(glm::radians(0.0f), glm::vec3(1.0, 0.0f, 0.0f));
-		translate = glm::translate(glm::vec3(2.0f, 0.06f, 0.0f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		plate.render();
-
-
-		/*
-		* BURGERS
-		*/
-		glBindTexture(GL_TEXTURE_2D, burgerTexture);
-		ourShader.setInt("ourTexture", 0);
-
-		scale = glm::scale(glm::vec3(0.4f));
-		rotation = glm::rotate(glm::radians(0.0f), glm::vec3(1.0, 0.0f, 0.0f));
-		translate = glm::translate(glm::vec3(-2.3f, 0.1f, -0.3f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		burger.render();
-
-		scale = glm::scale(glm::vec3(0.4f));
-		rotation = glm::rotate(glm::radians(0.0f), glm::vec3(1.0, 0.0f, 0.0f));
-		translate = glm::translate(glm::vec3(-1.7f, 0.1f, 0.5f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		burger.render();
-
-
-		/*
-		* SAUSAGE TRANSFORMATIONS
-		*/
-		scale = glm::scale(glm::vec3(0.2f, 0.35f, 0.25f));
-		rotation = glm::rotate(glm::radians(90.0f), glm::vec3(0.2, 0.0f, 1.0f));
-		translate = glm::translate(glm::vec3(2.0f, 0.1f, -0.4f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		sausage.render();
+		processInput(window, scene);			// process and apply user input
 
-	
-		/*
-		* CORN TRANSFORMATIONS
-		*/
-		// set corn texture for corn pieces
-		glBindTexture(GL_TEXTURE_2D, cornTexture);
-		ourShader.setInt("ourTexture", 0);
-
-		scale = glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
-		rotation = glm::rotate(glm::radians(-90.0f), glm::vec3(0.0, 0.0f, 1.0f));
-		translate = glm::translate(glm::vec3(2.5f, 0.2f, 0.4f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		cornEnd.render();
-
-		scale = glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
-		rotation = glm::rotate(glm::radians(90.0f), glm::vec3(0.0, 0.0f, 1.0f));
-		translate = glm::translate(glm::vec3(1.5f, 0.2f, 0.4f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		cornEnd.render();
-
-		scale = glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
-		rotation = glm::rotate(glm::radians(90.0f), glm::vec3(0.0, 0.0f, 1.0f));
-		translate = glm::translate(glm::vec3(2.0f, 0.2f, 0.4f));
-		model = translate * rotation * scale;
-		// model uniform data 
-		ourShader.setMat4("model", model);
-		cornMiddle.render();
+		// draw the scene
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		scene.render(camera, (float)WIDTH / (float)HEIGHT, framebufferHeight);
 
 		glfwSwapBuffers(window);	// swap buffers every frame
 		glfwPollEvents();			// retrieve user input
 	}
 
-	// destroy meshes and shader program
-	cornEnd.deleteVBO();
-	cornMiddle.deleteVBO();
-	glDeleteProgram(ourShader.ID);
+	// destroy meshes, textures and shader program
+	scene.destroy();
 
 	glfwTerminate();				// terminate to clear all GLFW resourses
 	return 0;
@@ -439,6 +146,8 @@ bool initializeWindow(GLFWwindow** window)
 		std::cout << "Failed to initialize GLAD" << std::endl;		// error message if unable to load GLAD pointers
 		return false;
 	}
+	// and what the context has beyond the 3.3 core
+	loadExtensions((GLADloadproc)glfwGetProcAddress);
 	
 
 	return true;
@@ -457,7 +166,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 /* 
 processes the user input from keyboard while running
 */
-void processInput(GLFWwindow* window)
+void processInput(GLFWwindow* window, Scene& scene)
 {
 	// close window when 'ESC' key is pressed
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
@@ -465,11 +174,53 @@ void processInput(GLFWwindow* window)
 
 	// switch to wireframe mode when '1' is pressed
 	if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		glState.polygonMode(GL_LINE);
 
 	// switch to fill mode when '2' is pressed
 	if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		glState.polygonMode(GL_FILL);
+
+	// turn the depth pre-pass on when '3' is pressed
+	if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+		scene.setDepthPrepass(true);
+
+	// turn the depth pre-pass off when '4' is pressed
+	if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+		scene.setDepthPrepass(false);
+
+	// sort opaque objects front to back when '5' is pressed
+	if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS)
+		scene.setSortMode(RenderQueue::SORT_FRONT_TO_BACK);
+
+	// sort opaque objects by program/texture/mesh when '6' is pressed
+	if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS)
+		scene.setSortMode(RenderQueue::SORT_BY_STATE);
+
+	// cull hidden props with GPU occlusion queries when '7' is pressed
+	if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS)
+		scene.setOcclusionMode(Scene::OCCLUSION_QUERIES);
+
+	// turn occlusion culling off when '8' is pressed
+	if (glfwGetKey(window, GLFW_KEY_8) == GLFW_PRESS)
+		scene.setOcclusionMode(Scene::OCCLUSION_OFF);
+
+	// cull hidden props with the software depth rasterizer when '9' is pressed
+	if (glfwGetKey(window, GLFW_KEY_9) == GLFW_PRESS)
+		scene.setOcclusionMode(Scene::OCCLUSION_SOFTWARE);
+
+	// print the prop under the crosshair when the left mouse button goes down
+	static bool wasPicking = false;
+	const bool picking = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+	if (picking && !wasPicking)
+	{
+		const int object = scene.pick(camera, 100.0f);
+		if (object >= 0)
+			std::cout << "Picked " << scene.objectName(object) << std::endl;
+	}
+	wasPicking = picking;
+
+	// remember where the camera was, moves into a prop are undone below
+	const glm::vec3 lastPosition = camera.Position;
 
 	// move camera forward
 	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
@@ -494,6 +245,10 @@ void processInput(GLFWwindow* window)
 	// move camera down
 	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
 		camera.ProcessKeyboard(DOWN, deltaTime);
+
+	// keep the camera from flying through the props
+	if (scene.collides(camera.Position, 0.1f))
+		camera.Position = lastPosition;
 }
 
 /*
@@ -0,0 +1,100 @@
+// STL
+#include <cstring>
+#include <unordered_map>
+
+// Project
+#include "meshregistry.h"
+
+// unnamed namespace
+namespace
+{
+	enum MeshType
+	{
+		CYLINDER,
+		PLANE
+	};
+
+	// mesh type plus its constructor parameters, unused parameters left at zero
+	struct MeshKey
+	{
+		int type;
+		float params[6];
+
+		bool operator==(const MeshKey& other) const
+		{
+			return type == other.type && memcmp(params, other.params, sizeof(params)) == 0;
+		}
+	};
+
+	// FNV-1a over the raw key bytes
+	struct MeshKeyHash
+	{
+		size_t operator()(const MeshKey& key) const
+		{
+			const unsigned char* bytes = (const unsigned char*)&key;
+			unsigned long long hash = 14695981039346656037ull;
+			for (size_t i = 0; i < sizeof(MeshKey); i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return (size_t)hash;
+		}
+	};
+
+	// expired entries are simply overwritten the next time their key is requested
+	std::unordered_map<MeshKey, std::weak_ptr<void>, MeshKeyHash> meshes;
+
+	// returns the live mesh for the key, or builds one with the given constructor
+	template <class T, class Create>
+	std::shared_ptr<T> acquire(const MeshKey& key, Create create)
+	{
+		std::weak_ptr<void>& entry = meshes[key];
+		if (std::shared_ptr<void> existing = entry.lock())
+			return std::static_pointer_cast<T>(existing);
+
+		// last handle out deletes the GPU buffers
+		std::shared_ptr<T> mesh(create(), [](T* mesh)
+		{
+			mesh->deleteVBO();
+			delete mesh;
+		});
+		entry = mesh;
+		return mesh;
+	}
+}
+
+std::shared_ptr<Cylinder> MeshRegistry::cylinder(float topRadius, float bottomRadius, int numSlices, float height, bool topCircle, bool bottomCircle)
+{
+	MeshKey key = {};
+	key.type = CYLINDER;
+	key.params[0] = topRadius;
+	key.params[1] = bottomRadius;
+	key.params[2] = (float)numSlices;
+	key.params[3] = height;
+	key.params[4] = topCircle ? 1.0f : 0.0f;
+	key.params[5] = bottomCircle ? 1.0f : 0.0f;
+
+	return acquire<Cylinder>(key, [&]() { return new Cylinder(topRadius, bottomRadius, numSlices, height, topCircle, bottomCircle); });
+}
+
+std::shared_ptr<Plane> MeshRegistry::plane(float x, float z)
+{
+	MeshKey key = {};
+	key.type = PLANE;
+	key.params[0] = x;
+	key.params[1] = z;
+
+	return acquire<Plane>(key, [&]() { return new Plane(x, z); });
+}
+
+int MeshRegistry::liveMeshes()
+{
+	int count = 0;
+	for (const auto& entry : meshes)
+	{
+		if (!entry.second.expired())
+			count++;
+	}
+	return count;
+}
@@ -0,0 +1,137 @@
+// GLAD header
+#include <glad/glad.h>	
+
+// Project
+#include "occlusion.h"
+#include "glstate.h"
+#include "renderstats.h"
+
+// unnamed namespace
+namespace
+{
+	// corners of a cube from -1 to 1
+	const float CUBE_VERTICES[] = {
+		-1.0f, -1.0f, -1.0f,
+		 1.0f, -1.0f, -1.0f,
+		 1.0f,  1.0f, -1.0f,
+		-1.0f,  1.0f, -1.0f,
+		-1.0f, -1.0f,  1.0f,
+		 1.0f, -1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,
+		-1.0f,  1.0f,  1.0f
+	};
+
+	// two triangles per face, winding does not matter as culling is off for queries
+	const unsigned int CUBE_INDICES[] = {
+		0, 1, 2, 2, 3, 0,	// back
+		4, 5, 6, 6, 7, 4,	// front
+		0, 4, 7, 7, 3, 0,	// left
+		1, 5, 6, 6, 2, 1,	// right
+		0, 1, 5, 5, 4, 0,	// bottom
+		3, 2, 6, 6, 7, 3	// top
+	};
+}
+
+OcclusionCuller::OcclusionCuller()
+	: boxShader("occlusion.vert", "depth.frag")
+{
+	boxCenter = boxShader.uniform("boxCenter");
+	boxExtents = boxShader.uniform("boxExtents");
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	glState.bindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(CUBE_INDICES), CUBE_INDICES, GL_STATIC_DRAW);
+
+	// vertex positions
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+}
+
+void OcclusionCuller::resize(unsigned int count)
+{
+	if (!queries.empty())
+		glDeleteQueries((GLsizei)queries.size(), queries.data());
+
+	queries.assign(count, 0);
+	if (count > 0)
+		glGenQueries((GLsizei)count, queries.data());
+	pending.assign(count, 0);
+	issued.assign(count, 0);
+	occluded.assign(count, 0);
+}
+
+void OcclusionCuller::collectResults()
+{
+	for (unsigned int object = 0; object < queries.size(); object++)
+	{
+		if (!pending[object])
+			continue;
+
+		// a query still in flight keeps its last result
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(queries[object], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			continue;
+
+		GLuint anySamples = GL_FALSE;
+		glGetQueryObjectuiv(queries[object], GL_QUERY_RESULT, &anySamples);
+		occluded[object] = anySamples ? 0 : 1;
+		pending[object] = 0;
+	}
+}
+
+void OcclusionCuller::beginQueries()
+{
+	// test against the depth of everything drawn so far, without changing it
+	glState.colorMask(false);
+	glState.depthMask(false);
+	glState.depthFunc(GL_LEQUAL);
+	glState.disable(GL_CULL_FACE);
+
+	boxShader.use();
+	glState.bindVertexArray(VAO);
+}
+
+void OcclusionCuller::endQueries()
+{
+	glState.colorMask(true);
+	glState.depthMask(true);
+	glState.depthFunc(GL_LESS);
+}
+
+void OcclusionCuller::issueQuery(unsigned int object, const Bounds& worldBounds)
+{
+	if (pending[object])
+		return;
+
+	boxShader.setVec3(boxCenter, worldBounds.center);
+	boxShader.setVec3(boxExtents, worldBounds.extents);
+
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, queries[object]);
+	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0);
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+	renderStats.occlusionQueries++;
+
+	pending[object] = 1;
+	issued[object] = 1;
+}
+
+unsigned int OcclusionCuller::query(unsigned int object) const
+{
+	return issued[object] ? queries[object] : 0;
+}
+
+void OcclusionCuller::destroy()
+{
+	resize(0);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glState.deleteVertexArray(VAO);
+	glState.deleteProgram(boxShader.ID);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;		// unit cube corner, -1 to 1 on each axis
+
+// same block as shader.vert, only the matrices are read
+layout (std140) uniform FrameData
+{
+	mat4 projection;
+	mat4 view;
+	vec3 viewPos;
+	vec3 lightPos;
+	vec3 lightColor;
+};
+
+// world-space box of the object being tested
+uniform vec3 boxCenter;
+uniform vec3 boxExtents;
+
+void main()
+{
+	gl_Position = projection * view * vec4(boxCenter + aPos * boxExtents, 1.0);
+}
\ No newline at end of file
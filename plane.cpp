@@ -1,37 +1,45 @@
 // STL
 #include <vector>
 #include <iostream>
+#include <cmath>
 
 // GLAD header
 #include <glad/glad.h>	
 
 // Project
 #include "plane.h"
+#include "renderstats.h"
+#include "glstate.h"
 
 Plane::Plane(float x, float z)
+	: halfSizeX(x), halfSizeZ(z)
 {
+	// flat box, the sphere reaches the corners
+	localBounds.extents = glm::vec3(x, 0.0f, z);
+	localBounds.radius = std::sqrt(x * x + z * z);
+
 	// postions
 	std::vector<glm::vec3> positions;
-	// first triangle
+	// first triangle, counter-clockwise seen from above
 	positions.push_back(glm::vec3(-x, 0.0f, z));
-	positions.push_back(glm::vec3(-x, 0.0f, -z));
 	positions.push_back(glm::vec3(x, 0.0f, -z));
+	positions.push_back(glm::vec3(-x, 0.0f, -z));
 	// second triangle
 	positions.push_back(glm::vec3(-x, 0.0f, z));
-	positions.push_back(glm::vec3(x, 0.0f, -z));
 	positions.push_back(glm::vec3(x, 0.0f, z));
+	positions.push_back(glm::vec3(x, 0.0f, -z));
 
 
 	// texture coords
 	std::vector<glm::vec2> texCoords;
 	// first triangle
 	texCoords.push_back(glm::vec2(0.0f, 1.0f));
-	texCoords.push_back(glm::vec2(0.0f, 0.0f));
 	texCoords.push_back(glm::vec2(1.0f, 0.0f));
+	texCoords.push_back(glm::vec2(0.0f, 0.0f));
 	// second triangle
 	texCoords.push_back(glm::vec2(0.0f, 1.0f));
-	texCoords.push_back(glm::vec2(1.0f, 0.0f));
 	texCoords.push_back(glm::vec2(1.0f, 1.0f));
+	texCoords.push_back(glm::vec2(1.0f, 0.0f));
 
 
 	// normals
@@ -57,7 +65,7 @@ Plane::Plane(float x, float z)
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
 
-	glBindVertexArray(VAO);
+	glState.bindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices.front(), GL_STATIC_DRAW);
@@ -71,18 +79,46 @@ Plane::Plane(float x, float z)
 	// vertex normals
 	glEnableVertexAttribArray(2);
 	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	// per-instance model and normal matrices
+	instanceBuffer.attach();
 }
 
 void Plane::render() const
 {
-	glBindVertexArray(VAO);
+	glState.bindVertexArray(VAO);
 
 	// render sides of cone
 	glDrawArrays(GL_TRIANGLES, 0, 6);
+	renderStats.drawCalls++;
+
+}
+
+void Plane::renderInstanced(const glm::mat4* models, int count)
+{
+	instanceBuffer.upload(models, count);
 
+	glState.bindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+	renderStats.drawCalls++;
 }
 
 void Plane::deleteVBO()
 {
 	glDeleteBuffers(1, &VBO);
+	instanceBuffer.deleteVBO();
+	glState.deleteVertexArray(VAO);
+}
+
+void Plane::occluderTriangles(std::vector<glm::vec3>& triangles) const
+{
+	const glm::vec3 corners[4] = {
+		glm::vec3(-halfSizeX, 0.0f, halfSizeZ),
+		glm::vec3(halfSizeX, 0.0f, halfSizeZ),
+		glm::vec3(halfSizeX, 0.0f, -halfSizeZ),
+		glm::vec3(-halfSizeX, 0.0f, -halfSizeZ)
+	};
+
+	const int order[6] = { 0, 2, 3, 0, 1, 2 };
+	for (int i = 0; i < 6; i++)
+		triangles.push_back(corners[order[i]]);
 }
\ No newline at end of file
@@ -0,0 +1,240 @@
+// GLAD header
+#include <glad/glad.h>	
+
+// Project
+#include "renderqueue.h"
+#include "normalmatrix.h"
+#include "glstate.h"
+#include "renderstats.h"
+
+RenderQueue::RenderQueue(UniformBuffer& objectBuffer)
+	: objectBuffer(objectBuffer), view(1.0f), farPlane(1.0f), frustumCulling(true), culled(false)
+{
+}
+
+void RenderQueue::begin(const glm::mat4& projection, const glm::mat4& view, float farPlane)
+{
+	this->view = view;
+	this->farPlane = farPlane;
+	frustum = Frustum(projection * view);
+	culled = false;
+
+	draws.clear();
+	models.clear();
+	bounds.clear();
+}
+
+void RenderQueue::submit(Shader& shader, unsigned int texture, Mesh& mesh, const glm::mat4& model, int layer, unsigned int sampler)
+{
+	add(shader, texture, layer, sampler, mesh, &model, 1, false);
+}
+
+void RenderQueue::submitInstanced(Shader& shader, unsigned int texture, Mesh& mesh, const glm::mat4* models, int count, int layer, unsigned int sampler)
+{
+	add(shader, texture, layer, sampler, mesh, models, count, true);
+}
+
+void RenderQueue::submitConditional(Shader& shader, unsigned int texture, Mesh& mesh, const glm::mat4& model, unsigned int query, int layer, unsigned int sampler)
+{
+	add(shader, texture, layer, sampler, mesh, &model, 1, false);
+	draws.back().condition = query;
+}
+
+void RenderQueue::add(Shader& shader, unsigned int texture, int layer, unsigned int sampler, Mesh& mesh, const glm::mat4* models, int count, bool instanced)
+{
+	// nearest instance decides the depth of the whole draw
+	float depth = farPlane;
+	for (int i = 0; i < count; i++)
+	{
+		const glm::vec4 viewPosition = view * models[i][3];
+		depth = glm::min(depth, -viewPosition.z);
+		bounds.push(transformBounds(mesh.bounds(), models[i]));
+	}
+
+	Draw draw;
+	draw.shader = &shader;
+	draw.mesh = &mesh;
+	draw.texture = texture;
+	draw.layer = layer;
+	draw.sampler = sampler;
+	draw.depth = depth / farPlane;
+	draw.firstModel = (int)this->models.size();
+	draw.numModels = count;
+	draw.instanced = instanced;
+	draw.condition = 0;
+
+	this->models.insert(this->models.end(), models, models + count);
+	draws.push_back(draw);
+}
+
+void RenderQueue::setFrustumCulling(bool enabled)
+{
+	frustumCulling = enabled;
+}
+
+void RenderQueue::execute(SortMode mode)
+{
+	cull();
+	sort(mode);
+
+	Shader* currentShader = NULL;
+	Shader::Uniform instancedUniform;
+	Shader::Uniform layerUniform;
+
+	for (unsigned int index : order)
+	{
+		const Draw& draw = draws[index];
+
+		if (draw.shader != currentShader)
+		{
+			currentShader = draw.shader;
+			currentShader->use();
+			instancedUniform = currentShader->uniform("instanced");
+			layerUniform = currentShader->uniform("layer");
+			currentShader->setInt(currentShader->uniform("ourTexture"), 0);
+			currentShader->setInt(currentShader->uniform("textureArray"), 1);
+		}
+
+		// 2D textures on unit 0, arrays on unit 1 so the two sampler types never share a unit
+		const unsigned int unit = draw.layer < 0 ? 0 : 1;
+		glState.bindTexture(draw.layer < 0 ? GL_TEXTURE_2D : GL_TEXTURE_2D_ARRAY, draw.texture, unit);
+		glState.bindSampler(unit, draw.sampler);
+		currentShader->setInt(layerUniform, draw.layer);
+		issue(draw, *currentShader, instancedUniform);
+	}
+}
+
+void RenderQueue::executeDepthOnly(Shader& depthShader)
+{
+	cull();
+	sort(SORT_FRONT_TO_BACK);
+
+	depthShader.use();
+	const Shader::Uniform instancedUniform = depthShader.uniform("instanced");
+
+	for (unsigned int index : order)
+		issue(draws[index], depthShader, instancedUniform);
+}
+
+void RenderQueue::cull()
+{
+	if (culled || !frustumCulling)
+		return;
+	culled = true;
+
+	visible.resize(bounds.size());
+	frustum.testBatch(bounds, visible.data());
+	renderStats.objectsTested += bounds.size();
+
+	// keep the visible instances of each draw at the front of its range,
+	// and drop draws that have none left
+	unsigned int numDraws = 0;
+	for (unsigned int d = 0; d < draws.size(); d++)
+	{
+		Draw draw = draws[d];
+		int numVisible = 0;
+		for (int i = 0; i < draw.numModels; i++)
+		{
+			if (visible[draw.firstModel + i])
+				models[draw.firstModel + numVisible++] = models[draw.firstModel + i];
+		}
+		renderStats.objectsCulled += draw.numModels - numVisible;
+
+		draw.numModels = numVisible;
+		if (numVisible > 0)
+			draws[numDraws++] = draw;
+	}
+	draws.resize(numDraws);
+}
+
+void RenderQueue::issue(const Draw& draw, Shader& shader, Shader::Uniform instancedUniform)
+{
+	if (draw.mesh->isDoubleSided())
+		glState.disable(GL_CULL_FACE);
+	else
+		glState.enable(GL_CULL_FACE);
+
+	if (draw.instanced)
+	{
+		shader.setBool(instancedUniform, true);
+		draw.mesh->renderInstanced(&models[draw.firstModel], draw.numModels);
+	}
+	else
+	{
+		// model uniform data
+		const glm::mat4& model = models[draw.firstModel];
+		const glm::mat3 normalMatrix = computeNormalMatrix(model);
+
+		ObjectData object;
+		object.model = model;
+		for (int column = 0; column < 3; column++)
+			object.normalMatrix[column] = glm::vec4(normalMatrix[column], 0.0f);
+		objectBuffer.update(&object);
+
+		shader.setBool(instancedUniform, false);
+
+		// the query decides on the GPU whether the mesh is drawn
+		if (draw.condition != 0)
+			glBeginConditionalRender(draw.condition, GL_QUERY_WAIT);
+		draw.mesh->render();
+		if (draw.condition != 0)
+			glEndConditionalRender();
+	}
+}
+
+unsigned long long RenderQueue::makeKey(SortMode mode, unsigned int program, unsigned int texture, unsigned int sampler,
+	unsigned int mesh, float depth)
+{
+	// depth as a fraction of the far plane, clamped to [0, 1]
+	depth = glm::clamp(depth, 0.0f, 1.0f);
+	const unsigned long long quantizedDepth = (unsigned long long)(depth * 16777215.0f);
+
+	const unsigned long long state = ((unsigned long long)(program & 0x3FF) << 30) |
+		((unsigned long long)(texture & 0x3FF) << 20) |
+		((unsigned long long)(sampler & 0xF) << 16) |
+		(unsigned long long)(mesh & 0xFFFF);
+
+	if (mode == SORT_FRONT_TO_BACK)
+		return (quantizedDepth << 40) | state;
+	return (state << 24) | quantizedDepth;
+}
+
+void RenderQueue::sort(SortMode mode)
+{
+	const unsigned int count = (unsigned int)draws.size();
+	keys.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+		keys[i] = makeKey(mode, draws[i].shader->ID, draws[i].texture, draws[i].sampler, draws[i].mesh->vertexArray(), draws[i].depth);
+
+	order.resize(count);
+	scratch.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+		order[i] = i;
+
+	// one counting pass per byte, least significant first
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		unsigned int histogram[256] = {};
+		for (unsigned int i = 0; i < count; i++)
+			histogram[(keys[i] >> shift) & 0xFF]++;
+
+		// every key has the same byte here, order would not change
+		if (count == 0 || histogram[(keys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		unsigned int offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			const unsigned int size = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += size;
+		}
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const unsigned int index = order[i];
+			scratch[histogram[(keys[index] >> shift) & 0xFF]++] = index;
+		}
+		order.swap(scratch);
+	}
+}
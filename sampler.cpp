@@ -0,0 +1,64 @@
+// STL
+#include <algorithm>
+#include <map>
+#include <utility>
+
+// GLAD header
+#include <glad/glad.h>
+
+// Project
+#include "sampler.h"
+#include "glstate.h"
+#include "glextensions.h"
+
+// unnamed namespace
+namespace
+{
+	const GLenum MIN_FILTERS[] = { GL_LINEAR, GL_LINEAR_MIPMAP_NEAREST, GL_LINEAR_MIPMAP_LINEAR };
+
+	// expired entries are simply overwritten the next time their settings are requested
+	std::map<std::pair<int, float>, std::weak_ptr<Sampler>> samplers;
+}
+
+std::shared_ptr<Sampler> Sampler::get(MipFilter mipFilter, float anisotropy)
+{
+	anisotropy = std::max(1.0f, std::min(anisotropy, maxAnisotropy()));
+
+	std::weak_ptr<Sampler>& entry = samplers[std::make_pair((int)mipFilter, anisotropy)];
+	if (std::shared_ptr<Sampler> existing = entry.lock())
+		return existing;
+
+	std::shared_ptr<Sampler> sampler(new Sampler(mipFilter, anisotropy));
+	entry = sampler;
+	return sampler;
+}
+
+float Sampler::maxAnisotropy()
+{
+	// asked once, the answer does not change for the context
+	static float maximum = 0.0f;
+	if (maximum == 0.0f)
+	{
+		maximum = 1.0f;
+		if (hasExtension("GL_EXT_texture_filter_anisotropic"))
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maximum);
+	}
+	return maximum;
+}
+
+Sampler::Sampler(MipFilter mipFilter, float anisotropy)
+	: samplerID(0), filter(mipFilter), maxSamples(anisotropy)
+{
+	glGenSamplers(1, &samplerID);
+	glSamplerParameteri(samplerID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glSamplerParameteri(samplerID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glSamplerParameteri(samplerID, GL_TEXTURE_MIN_FILTER, MIN_FILTERS[mipFilter]);
+	glSamplerParameteri(samplerID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	if (anisotropy > 1.0f)
+		glSamplerParameterf(samplerID, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+}
+
+Sampler::~Sampler()
+{
+	glState.deleteSampler(samplerID);
+}
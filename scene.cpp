@@ -0,0 +1,584 @@
+// STL
+#include <algorithm>
+#include <cmath>
+
+// GLAD header
+#include <glad/glad.h>
+
+// GLM headers 
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Project
+#include "scene.h"
+#include "meshregistry.h"
+#include "glstate.h"
+#include "renderstats.h"
+
+// stb_image headers for image textures
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+RenderStats renderStats;
+
+/*
+* creates the shader program, meshes and textures for the scene
+*/
+Scene::Scene(bool packTextures, TextureLoader::Compression compression)
+	: ourShader("shader.vert", "shader.frag"),
+	depthShader("depth.vert", "depth.frag"),
+	frameBuffer(FRAME_BLOCK_BINDING, sizeof(FrameData)),
+	objectBuffer(OBJECT_BLOCK_BINDING, sizeof(ObjectData)),
+	queue(objectBuffer),
+	plane(MeshRegistry::plane(1.0f, 1.0f)),
+	cornMiddle(MeshRegistry::cylinder(1.0f, 1.0f, 100, 3.0f, true, true)),
+	cornEnd(MeshRegistry::cylinder(0.6f, 1.0f, 100, 2.0f, true, true)),
+	skilletMain(MeshRegistry::cylinder(1.0f, 0.8f, 100, 1.0f, false, true)),
+	rod(MeshRegistry::cylinder(0.5f, 0.5f, 50, 1.0f, true, true)),
+	burger(MeshRegistry::cylinder(1.0f, 1.0f, 50, 0.25f, true, true)),
+	plate(MeshRegistry::cylinder(1.0f, 0.8f, 50, 0.1f, false, true)),
+	packTextures(packTextures),
+	lightPos(-5.0f, 2.0f, 0.0f),
+	sortMode(RenderQueue::SORT_FRONT_TO_BACK),
+	depthPrepass(false),
+	occlusionMode(OCCLUSION_QUERIES),
+	frameIndex(0)
+{
+	textureLoader.setCompression(compression);
+	loadTextures();
+	setTextureFiltering(Sampler::MIP_LINEAR, DEFAULT_ANISOTROPY);
+
+	// the scene BVH culls the props, the queue does not need to test them again
+	queue.setFrustumCulling(false);
+	placeObjects();
+	occlusion.resize((unsigned int)objects.size());
+	rasterizer.setOccluders(occluderTriangles);
+}
+
+
+/*
+* queues the textures, packed into one texture array or as separate 2D textures.
+* they show a placeholder until the loader has decoded and uploaded them. images
+* with the same content share one 2D texture
+*/
+void Scene::loadTextures()
+{
+	const char* paths[] = { "corn.jpg", "table.jpg", "skillet.jpg", "burger.jpg", "plate.jpg" };
+	SceneTexture* textures[] = { &cornTexture, &tableTexture, &skilletTexture, &burgerTexture, &plateTexture };
+	const SamplerKind samplerKinds[] = { SAMPLER_PROP, SAMPLER_SURFACE, SAMPLER_PROP, SAMPLER_PROP, SAMPLER_PROP };
+	const int numTextures = 5;
+
+	if (packTextures)
+		textureArray.create(numTextures, TEXTURE_LAYER_SIZE, textureLoader.compression() != TextureLoader::COMPRESSION_OFF);
+
+	for (int i = 0; i < numTextures; i++)
+	{
+		textures[i]->sampler = samplerKinds[i];
+		if (packTextures)
+		{
+			textures[i]->name = textureArray.texture();
+			textures[i]->layer = i;
+			textureLoader.loadLayer(textureArray, i, paths[i]);
+		}
+		else
+		{
+			textures[i]->name = textureLoader.load2D(paths[i]);
+			textures[i]->layer = -1;
+		}
+	}
+}
+
+
+/*
+* places the props on the table and builds the BVH over them
+*/
+void Scene::placeObjects()
+{
+	/*
+	* PLANE TRANSFORMATIONS
+	*/
+
+	// ashpalt texture for plane
+	glm::mat4 scale = glm::scale(glm::vec3(5.0f, 5.0f, 3.5f));
+	glm::mat4 rotation = glm::rotate(glm::radians(0.0f), glm::vec3(0.0, 1.0f, 0.0f));
+	glm::mat4 translate = glm::translate(glm::vec3(0.0f, 0.0f, 0.0f));
+	glm::mat4 model = translate * rotation * scale;
+	addObject("table", *plane, tableTexture, model, true);
+
+
+	/*
+	* SKILLET
+	*/
+	// metal texture for skillet
+	scale = glm::scale(glm::vec3(1.5f, 0.5f, 1.5f));
+	rotation = glm::rotate(glm::radians(0.0f), glm::vec3(0.0, 0.0f, 1.0f));
+	translate = glm::translate(glm::vec3(-2.0f, 0.26f, 0.0f));
+	model = translate * rotation * scale;
+	addObject("skillet", *skilletMain, skilletTexture, model, true);
+
+	// the rod is unit height, the handle is half a unit long before scaling
+	scale = glm::scale(glm::vec3(0.3f, 2.75f * 0.5f, 0.1f));
+	rotation = glm::rotate(glm::radians(90.0f), glm::vec3(1.0, 0.0f, 0.0f));
+	translate = glm::translate(glm::vec3(-2.0f, 0.4f, 2.12f));
+	model = translate * rotation * scale;
+	addObject("skillet handle", *rod, skilletTexture, model);
+
+
+	/*
+	* PLATE
+	*/
+	scale = glm::scale(glm::vec3(1.0f, 1.0f, 1.0f));
+	rotation = glm::rotate(glm::radians(0.0f), glm::vec3(1.0, 0.0f, 0.0f));
+	translate = glm::translate(glm::vec3(2.0f, 0.06f, 0.0f));
+	model = translate * rotation * scale;
+	addObject("plate", *plate, plateTexture, model, true);
+
+
+	/*
+	* BURGERS
+	*/
+	scale = glm::scale(glm::vec3(0.4f));
+	rotation = glm::rotate(glm::radians(0.0f), glm::vec3(1.0, 0.0f, 0.0f));
+	translate = glm::translate(glm::vec3(-2.3f, 0.1f, -0.3f));
+	model = translate * rotation * scale;
+	addObject("burger", *burger, burgerTexture, model);
+
+	scale = glm::scale(glm::vec3(0.4f));
+	rotation = glm::rotate(glm::radians(0.0f), glm::vec3(1.0, 0.0f, 0.0f));
+	translate = glm::translate(glm::vec3(-1.7f, 0.1f, 0.5f));
+	model = translate * rotation * scale;
+	addObject("burger", *burger, burgerTexture, model);
+
+
+	/*
+	* SAUSAGE TRANSFORMATIONS
+	*/
+	// shares the burger texture, and the rod mesh with the skillet handle at 3 units long
+	scale = glm::scale(glm::vec3(0.2f, 0.35f * 3.0f, 0.25f));
+	rotation = glm::rotate(glm::radians(90.0f), glm::vec3(0.2, 0.0f, 1.0f));
+	translate = glm::translate(glm::vec3(2.0f, 0.1f, -0.4f));
+	model = translate * rotation * scale;
+	addObject("sausage", *rod, burgerTexture, model);
+
+
+	/*
+	* CORN TRANSFORMATIONS
+	*/
+	// corn texture for corn pieces
+	scale = glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
+	rotation = glm::rotate(glm::radians(-90.0f), glm::vec3(0.0, 0.0f, 1.0f));
+	translate = glm::translate(glm::vec3(2.5f, 0.2f, 0.4f));
+	model = translate * rotation * scale;
+	addObject("corn end", *cornEnd, cornTexture, model);
+
+	scale = glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
+	rotation = glm::rotate(glm::radians(90.0f), glm::vec3(0.0, 0.0f, 1.0f));
+	translate = glm::translate(glm::vec3(1.5f, 0.2f, 0.4f));
+	model = translate * rotation * scale;
+	addObject("corn end", *cornEnd, cornTexture, model);
+
+	scale = glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
+	rotation = glm::rotate(glm::radians(90.0f), glm::vec3(0.0, 0.0f, 1.0f));
+	translate = glm::translate(glm::vec3(2.0f, 0.2f, 0.4f));
+	model = translate * rotation * scale;
+	addObject("corn", *cornMiddle, cornTexture, model);
+
+
+	bvh.build(objectBounds);
+}
+
+
+/*
+* adds a prop, props sharing a mesh and texture are put in the same batch.
+* occluders are the big props, drawn into the software depth buffer
+*/
+void Scene::addObject(const char* name, Mesh& mesh, SceneTexture texture, const glm::mat4& model, bool occluder)
+{
+	SceneObject object;
+	object.name = name;
+	object.mesh = &mesh;
+	object.texture = texture;
+	object.model = model;
+	object.occluder = occluder;
+	object.batch = (unsigned int)objects.size();
+	for (const SceneObject& other : objects)
+	{
+		if (other.mesh == &mesh && other.texture.name == texture.name && other.texture.layer == texture.layer)
+		{
+			object.batch = other.batch;
+			break;
+		}
+	}
+
+	objects.push_back(object);
+	objectBounds.push_back(transformBounds(mesh.bounds(), model));
+
+	if (occluder)
+	{
+		const size_t first = occluderTriangles.size();
+		mesh.occluderTriangles(occluderTriangles);
+		for (size_t i = first; i < occluderTriangles.size(); i++)
+			occluderTriangles[i] = glm::vec3(model * glm::vec4(occluderTriangles[i], 1.0f));
+	}
+}
+
+
+/*
+* draws one frame of the scene from the given camera
+*/
+void Scene::render(Camera& camera, float aspectRatio, int viewportHeight)
+{
+	/*
+	* PROJECTION, CAMERA AND LIGHT ATTRIBUTES
+	*/
+
+	// shared by every program through the FrameData block, written once per frame
+	FrameData frame;
+	frame.projection = glm::perspective(glm::radians(camera.Zoom), aspectRatio, 0.1f, 100.0f);
+	frame.view = camera.GetViewMatrix();
+	frame.viewPos = glm::vec4(camera.Position, 1.0f);
+	frame.lightPos = glm::vec4(lightPos, 1.0f);
+	frame.lightColor = glm::vec4(1.0f, 1.0f, 0.95f, 1.0f);
+
+	// the workers rasterize the occluders while this thread streams textures,
+	// sets up the frame and submits the occluder props, which are never culled
+	if (occlusionMode == OCCLUSION_SOFTWARE)
+		rasterizer.begin(frame.projection * frame.view);
+
+	// textures decoded since the last frame replace their placeholders, and
+	// the larger mip levels of earlier ones continue streaming in
+	requestTextureSizes(camera, viewportHeight);
+	textureLoader.update();
+
+	// enable z-depth and set background color
+	glState.enable(GL_DEPTH_TEST);
+	glState.clearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	// the clear honours the masks, the colour pass may have left depth writes off
+	glState.depthMask(true);
+	glState.colorMask(true);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	frameBuffer.update(&frame);
+
+
+	// only the props the BVH finds inside the frustum are submitted
+	visibleObjects.clear();
+	bvh.queryFrustum(Frustum(frame.projection * frame.view), visibleObjects);
+	renderStats.objectsTested += (unsigned int)objects.size();
+	renderStats.objectsCulled += (unsigned int)(objects.size() - visibleObjects.size());
+
+	queue.begin(frame.projection, frame.view, 100.0f);
+
+	// props that were hidden when last tested are held back from the main pass
+	occludedObjects.clear();
+	if (occlusionMode == OCCLUSION_SOFTWARE)
+	{
+		// the occluders themselves are kept and go in before the depth buffer is
+		// ready, the props behind them are dropped once it is
+		occluderObjects.clear();
+		size_t numCandidates = 0;
+		for (unsigned int object : visibleObjects)
+		{
+			if (objects[object].occluder)
+				occluderObjects.push_back(object);
+			else
+				visibleObjects[numCandidates++] = object;
+		}
+		visibleObjects.resize(numCandidates);
+		submitBatched(occluderObjects);
+
+		rasterizer.finish();
+
+		size_t numVisible = 0;
+		unsigned int numOccluded = 0;
+		for (unsigned int object : visibleObjects)
+		{
+			if (rasterizer.isOccluded(objectBounds[object]))
+				numOccluded++;
+			else
+				visibleObjects[numVisible++] = object;
+		}
+		visibleObjects.resize(numVisible);
+		renderStats.objectsOccluded += numOccluded;
+	}
+	else if (occlusionMode == OCCLUSION_QUERIES)
+	{
+		occlusion.collectResults();
+
+		size_t numVisible = 0;
+		for (unsigned int object : visibleObjects)
+		{
+			if (occlusion.isOccluded(object) && !insideBounds(camera.Position, objectBounds[object]))
+				occludedObjects.push_back(object);
+			else
+				visibleObjects[numVisible++] = object;
+		}
+		visibleObjects.resize(numVisible);
+		renderStats.objectsOccluded += (unsigned int)occludedObjects.size();
+	}
+
+	submitBatched(visibleObjects);
+
+
+	// sort and draw everything
+	if (depthPrepass)
+	{
+		// depth only with the trivial shader, front to back
+		glState.depthFunc(GL_LESS);
+		glState.colorMask(false);
+		queue.executeDepthOnly(depthShader);
+
+		// every visible fragment now matches the depth buffer exactly, so the
+		// Phong shader runs once per pixel and the draws can go in state order
+		glState.depthFunc(GL_LEQUAL);
+		glState.depthMask(false);
+		glState.colorMask(true);
+		queue.execute(RenderQueue::SORT_BY_STATE);
+	}
+	else
+	{
+		glState.depthFunc(GL_LESS);
+		queue.execute(sortMode);
+	}
+
+	if (occlusionMode == OCCLUSION_QUERIES)
+	{
+		// test props in view against the depth just drawn, read back next frame.
+		// visible props tend to stay visible, so each is only re-tested every few
+		// frames, held back props every frame so they reappear without delay
+		occlusion.beginQueries();
+		issueOcclusionQueries(visibleObjects, camera.Position, VISIBLE_QUERY_INTERVAL);
+		issueOcclusionQueries(occludedObjects, camera.Position, 1);
+		occlusion.endQueries();
+		frameIndex++;
+
+		// held back props are drawn only if their fresh query found samples, the GPU
+		// decides without a round trip to the CPU
+		if (!occludedObjects.empty())
+		{
+			queue.begin(frame.projection, frame.view, 100.0f);
+			for (unsigned int index : occludedObjects)
+			{
+				const SceneObject& object = objects[index];
+				queue.submitConditional(ourShader, object.texture.name, *object.mesh, object.model, occlusion.query(index),
+					object.texture.layer, samplers[object.texture.sampler]->id());
+			}
+			queue.execute(sortMode);
+		}
+	}
+}
+
+
+/*
+* submits the objects to the queue, objects sharing a mesh and texture go out as
+* one instanced draw
+*/
+void Scene::submitBatched(std::vector<unsigned int>& objectList)
+{
+	std::sort(objectList.begin(), objectList.end(), [this](unsigned int a, unsigned int b)
+	{
+		return objects[a].batch != objects[b].batch ? objects[a].batch < objects[b].batch : a < b;
+	});
+
+	for (size_t first = 0; first < objectList.size();)
+	{
+		const SceneObject& object = objects[objectList[first]];
+
+		instanceModels.clear();
+		size_t last = first;
+		while (last < objectList.size() && objects[objectList[last]].batch == object.batch)
+			instanceModels.push_back(objects[objectList[last++]].model);
+
+		const unsigned int sampler = samplers[object.texture.sampler]->id();
+		if (instanceModels.size() == 1)
+			queue.submit(ourShader, object.texture.name, *object.mesh, object.model, object.texture.layer, sampler);
+		else
+			queue.submitInstanced(ourShader, object.texture.name, *object.mesh, instanceModels.data(), (int)instanceModels.size(),
+				object.texture.layer, sampler);
+		first = last;
+	}
+}
+
+
+/*
+* draws the bounding box of each object under its occlusion query, every interval frames
+*/
+void Scene::issueOcclusionQueries(const std::vector<unsigned int>& objectList, const glm::vec3& cameraPosition, unsigned int interval)
+{
+	for (unsigned int object : objectList)
+	{
+		// staggered so the queries spread evenly over the frames
+		if ((frameIndex + object) % interval != 0)
+			continue;
+
+		// from inside the box its faces are clipped away and the query would find
+		// nothing, so the object simply counts as visible
+		if (insideBounds(cameraPosition, objectBounds[object]))
+			occlusion.markVisible(object);
+		else
+			occlusion.issueQuery(object, objectBounds[object]);
+	}
+}
+
+
+/*
+* true when the point is inside the box, grown by the near plane distance
+*/
+bool Scene::insideBounds(const glm::vec3& point, const Bounds& bounds)
+{
+	const glm::vec3 offset = point - bounds.center;
+	const float margin = 0.1f;
+	return std::fabs(offset.x) <= bounds.extents.x + margin &&
+		std::fabs(offset.y) <= bounds.extents.y + margin &&
+		std::fabs(offset.z) <= bounds.extents.z + margin;
+}
+
+
+/*
+* draws opaque objects front to back (default) or grouped by state
+*/
+void Scene::setSortMode(RenderQueue::SortMode mode)
+{
+	sortMode = mode;
+}
+
+/*
+* lays down depth with a trivial shader before the colour pass, off by default
+*/
+void Scene::setDepthPrepass(bool enabled)
+{
+	depthPrepass = enabled;
+}
+
+/*
+* GPU queries that hold back props hidden last frame (default), the software
+* depth buffer, or no occlusion culling
+*/
+void Scene::setOcclusionMode(OcclusionMode mode)
+{
+	occlusionMode = mode;
+}
+
+
+/*
+* returns the prop straight ahead of the camera within maxDistance, or -1
+*/
+int Scene::pick(const Camera& camera, float maxDistance) const
+{
+	float distance;
+	return bvh.raycast(camera.Position, camera.Front, maxDistance, distance);
+}
+
+/*
+* name of a prop returned by pick()
+*/
+const char* Scene::objectName(int object) const
+{
+	return objects[object].name;
+}
+
+/*
+* true when a sphere at the given position would touch any prop's bounding box
+*/
+bool Scene::collides(const glm::vec3& position, float radius) const
+{
+	collisionHits.clear();
+	bvh.querySphere(position, radius, collisionHits);
+	return !collisionHits.empty();
+}
+
+
+/*
+* waits until every texture is decoded and uploaded
+*/
+void Scene::finishLoading()
+{
+	textureLoader.finish();
+}
+
+bool Scene::texturesLoaded()
+{
+	return textureLoader.idle();
+}
+
+/*
+* tells the texture loader how many pixels across each texture is drawn at, from
+* the distance of the nearest point of the props using it. every prop counts,
+* in view or not, so turning the camera does not drop levels
+*/
+void Scene::requestTextureSizes(const Camera& camera, int viewportHeight)
+{
+	const float pixelsPerUnit = (float)viewportHeight * 0.5f / tanf(glm::radians(camera.Zoom) * 0.5f);
+
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		const Bounds& bounds = objectBounds[i];
+		const float distance = std::max(glm::length(bounds.center - camera.Position) - bounds.radius, 0.1f);
+		// a texture wrapped around a cylinder spans about twice the prop's width
+		textureLoader.requireSize(objects[i].texture.name, 4.0f * bounds.radius * pixelsPerUnit / distance);
+	}
+}
+
+/*
+* caps the texture uploads of a frame once the small mip levels are in
+*/
+void Scene::setTextureStreamBudget(size_t bytesPerFrame)
+{
+	textureLoader.setStreamBudget(bytesPerFrame);
+}
+
+/*
+* texture data handed to GL, all mip levels
+*/
+size_t Scene::textureMemory() const
+{
+	return textureLoader.residentBytes();
+}
+
+/*
+* the samplers are shared, materials asking for the same settings get the same one
+*/
+void Scene::setTextureFiltering(Sampler::MipFilter mipFilter, float anisotropy)
+{
+	samplers[SAMPLER_PROP] = Sampler::get(mipFilter, 1.0f);
+	samplers[SAMPLER_SURFACE] = Sampler::get(mipFilter, anisotropy);
+}
+
+/*
+* caps the memory of the loaded textures, their finest levels are dropped to fit
+*/
+void Scene::setTextureMemoryBudget(size_t bytes)
+{
+	textureLoader.setMemoryBudget(bytes);
+}
+
+
+/*
+* destroys meshes, textures, uniform buffers and shader program
+*/
+void Scene::destroy()
+{
+	// releasing the last handle deletes the mesh buffers
+	plane.reset();
+	cornMiddle.reset();
+	cornEnd.reset();
+	skilletMain.reset();
+	rod.reset();
+	burger.reset();
+	plate.reset();
+
+	// the loader deletes the 2D textures, several props may share one
+	textureLoader.destroy();
+	for (std::shared_ptr<Sampler>& sampler : samplers)
+		sampler.reset();
+	if (packTextures)
+		textureArray.destroy();
+
+	occlusion.destroy();
+	frameBuffer.deleteBuffer();
+	objectBuffer.deleteBuffer();
+
+	glState.deleteProgram(ourShader.ID);
+	glState.deleteProgram(depthShader.ID);
+}
\ No newline at end of file
@@ -1,4 +1,7 @@
-#include "Shader.h"
+#include "shader.h"
+#include "renderstats.h"
+#include "uniformbuffer.h"
+#include "glstate.h"
 
 // constructor reads and build the shader
 // --------------------------------------
@@ -62,6 +65,8 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
 	glAttachShader(ID, fragment);
 	glLinkProgram(ID);
 	checkCompileErrors(ID, "PROGRAM");
+	buildUniformTable();
+	bindUniformBlocks();
 
 	// delete the shaders as they're linked into our program now and no longer necessary
 	glDeleteShader(vertex);
@@ -72,67 +77,208 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
 // -----------------------
 void Shader::use()
 {
-	glUseProgram(ID);
+	glState.useProgram(ID);
 }
 
 // utility uniform functions
 // -------------------------
+Shader::Uniform Shader::uniform(const std::string& name) const
+{
+	Uniform uniform;
+	auto found = uniformSlots.find(name);
+	if (found != uniformSlots.end())
+		uniform.slot = found->second;
+	return uniform;
+}
+
 void Shader::setBool(const std::string& name, bool value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+	setBool(uniform(name), value);
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+	setInt(uniform(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+	setFloat(uniform(name), value);
 }
 
 void Shader::setVec2(const std::string& name, const glm::vec2& value) const
 {
-	glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	setVec2(uniform(name), value);
 }
 void Shader::setVec2(const std::string& name, float x, float y) const
 {
-	glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+	setVec2(uniform(name), glm::vec2(x, y));
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
-	glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	setVec3(uniform(name), value);
 }
 void Shader::setVec3(const std::string& name, float x, float y, float z) const
 {
-	glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+	setVec3(uniform(name), glm::vec3(x, y, z));
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const
 {
-	glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	setVec4(uniform(name), value);
 }
 
 void Shader::setVec4(const std::string& name, float x, float y, float z, float w)
 {
-	glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+	setVec4(uniform(name), glm::vec4(x, y, z, w));
 }
 
 void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
 {
-	glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	setMat2(uniform(name), mat);
 }
 
 void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
 {
-	glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	setMat3(uniform(name), mat);
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	setMat4(uniform(name), mat);
+}
+
+
+// uniform functions taking pre-resolved handles
+// ---------------------------------------------
+void Shader::setBool(Uniform uniform, bool value) const
+{
+	setInt(uniform, (int)value);
+}
+
+void Shader::setInt(Uniform uniform, int value) const
+{
+	if (changed(uniform, &value, sizeof(value)))
+		glUniform1i(uniforms[uniform.slot].location, value);
+}
+
+void Shader::setFloat(Uniform uniform, float value) const
+{
+	if (changed(uniform, &value, sizeof(value)))
+		glUniform1f(uniforms[uniform.slot].location, value);
+}
+
+void Shader::setVec2(Uniform uniform, const glm::vec2& value) const
+{
+	if (changed(uniform, &value[0], sizeof(value)))
+		glUniform2fv(uniforms[uniform.slot].location, 1, &value[0]);
+}
+
+void Shader::setVec3(Uniform uniform, const glm::vec3& value) const
+{
+	if (changed(uniform, &value[0], sizeof(value)))
+		glUniform3fv(uniforms[uniform.slot].location, 1, &value[0]);
+}
+
+void Shader::setVec4(Uniform uniform, const glm::vec4& value) const
+{
+	if (changed(uniform, &value[0], sizeof(value)))
+		glUniform4fv(uniforms[uniform.slot].location, 1, &value[0]);
+}
+
+void Shader::setMat2(Uniform uniform, const glm::mat2& mat) const
+{
+	if (changed(uniform, &mat[0][0], sizeof(mat)))
+		glUniformMatrix2fv(uniforms[uniform.slot].location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setMat3(Uniform uniform, const glm::mat3& mat) const
+{
+	if (changed(uniform, &mat[0][0], sizeof(mat)))
+		glUniformMatrix3fv(uniforms[uniform.slot].location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setMat4(Uniform uniform, const glm::mat4& mat) const
+{
+	if (changed(uniform, &mat[0][0], sizeof(mat)))
+		glUniformMatrix4fv(uniforms[uniform.slot].location, 1, GL_FALSE, &mat[0][0]);
+}
+
+
+// builds the name -> location table from the linked program's active uniforms
+// ------------------------------------------------------------------------
+void Shader::buildUniformTable()
+{
+	int count = 0;
+	int maxLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	std::vector<char> name(maxLength + 1);
+	for (int i = 0; i < count; i++)
+	{
+		int length = 0;
+		int size = 0;
+		GLenum type;
+		glGetActiveUniform(ID, i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+		// uniform block members have no location of their own
+		int location = glGetUniformLocation(ID, name.data());
+		if (location < 0)
+			continue;
+
+		// arrays are reported as "name[0]", also answer to the plain name
+		std::string uniformName(name.data(), length);
+		if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+			uniformName.resize(uniformName.size() - 3);
+
+		UniformState state;
+		state.location = location;
+		state.hasValue = false;
+		uniformSlots[uniformName] = (int)uniforms.size();
+		uniforms.push_back(state);
+	}
+}
+
+// connects the shared uniform blocks this program uses to their fixed binding points
+// ------------------------------------------------------------------------
+void Shader::bindUniformBlocks()
+{
+	const struct
+	{
+		const char* name;
+		UniformBlockBinding binding;
+	} blocks[] = {
+		{ "FrameData", FRAME_BLOCK_BINDING },
+		{ "ObjectData", OBJECT_BLOCK_BINDING }
+	};
+
+	for (const auto& block : blocks)
+	{
+		unsigned int index = glGetUniformBlockIndex(ID, block.name);
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(ID, index, block.binding);
+	}
+}
+
+bool Shader::changed(Uniform uniform, const void* value, size_t size) const
+{
+	// uniform optimized out or misspelled, nothing to upload
+	if (uniform.slot < 0)
+		return false;
+
+	UniformState& state = uniforms[uniform.slot];
+	if (state.hasValue && memcmp(state.value, value, size) == 0)
+	{
+		renderStats.uniformUploadsSkipped++;
+		return false;
+	}
+
+	memcpy(state.value, value, size);
+	state.hasValue = true;
+	renderStats.uniformUploads++;
+	return true;
 }
 
 
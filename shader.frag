@@ -5,10 +5,19 @@ in vec2 texCoord;
 in vec3 normal;
 in vec3 fragPos;
 
-uniform vec3 lightPos; 
-uniform vec3 viewPos; 
-uniform vec3 lightColor;
+// written once per frame, shared with shader.vert
+layout (std140) uniform FrameData
+{
+	mat4 projection;
+	mat4 view;
+	vec3 viewPos;
+	vec3 lightPos;
+	vec3 lightColor;
+};
+
 uniform sampler2D ourTexture;
+uniform sampler2DArray textureArray;
+uniform int layer;		// layer of textureArray to sample, -1 for ourTexture
 
 void main()
 {
@@ -29,6 +38,7 @@ void main()
 	float spec = pow(max(dot(viewDirection, reflectDirection), 0.0f), 8.0f);
 	vec3 specular = specularStrength * spec * lightColor;
 
-	vec3 result = (ambient + diffuse + specular) * texture(ourTexture, texCoord).xyz;
+	vec3 color = layer < 0 ? texture(ourTexture, texCoord).xyz : texture(textureArray, vec3(texCoord, layer)).xyz;
+	vec3 result = (ambient + diffuse + specular) * color;
 	FragColor = vec4(result, 1.0f);
 }
\ No newline at end of file
@@ -2,19 +2,47 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 aNormal;
+layout (location = 3) in mat4 aInstanceModel;			// per instance, locations 3-6
+layout (location = 7) in mat3 aInstanceNormalMatrix;	// per instance, locations 7-9
 
 out vec2 texCoord;
 out vec3 normal;
 out vec3 fragPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// written once per frame, shared with shader.frag
+layout (std140) uniform FrameData
+{
+	mat4 projection;
+	mat4 view;
+	vec3 viewPos;
+	vec3 lightPos;
+	vec3 lightColor;
+};
+
+// written per non-instanced draw
+layout (std140) uniform ObjectData
+{
+	mat4 model;
+	mat3 normalMatrix;	// computed once per draw on the CPU
+};
+
+uniform bool instanced;		// read model/normal matrices from the instance attributes
+
+// depth.vert computes the same position for the depth pre-pass
+invariant gl_Position;
 
 void main()
 {
-	fragPos = vec3(model * vec4(aPos, 1.0));
-	normal = mat3(transpose(inverse(model))) * aNormal;
+	if (instanced)
+	{
+		fragPos = vec3(aInstanceModel * vec4(aPos, 1.0));
+		normal = aInstanceNormalMatrix * aNormal;
+	}
+	else
+	{
+		fragPos = vec3(model * vec4(aPos, 1.0));
+		normal = normalMatrix * aNormal;
+	}
 	texCoord = aTexCoord;
 
 	gl_Position = projection * view * vec4(fragPos, 1.0f);
@@ -0,0 +1,96 @@
+// STL
+#include <algorithm>
+#include <vector>
+
+// GLAD header
+#include <glad/glad.h>
+
+// Project
+#include "texturearray.h"
+#include "glstate.h"
+#include "glextensions.h"
+
+TextureArray::TextureArray()
+	: textureID(0), numLayers(0), size(0)
+{
+}
+
+void TextureArray::create(int numLayers, int layerSize, bool compressed)
+{
+	this->numLayers = numLayers;
+	size = layerSize;
+
+	glGenTextures(1, &textureID);
+	// wrapping and filtering come from the Sampler bound with it
+	glState.bindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+
+	if (!compressed)
+	{
+		// storage for all layers, grey until the images arrive. rows are tightly packed
+		std::vector<unsigned char> placeholder(layerSize * layerSize * numLayers * 3, (unsigned char)128);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, layerSize, layerSize, numLayers, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		return;
+	}
+
+	// the same grey as one BC1 block: both colours 565 grey, every index 0.
+	// GL cannot generate mipmaps of compressed textures, so each level is given
+	const unsigned char greyBlock[8] = { 0x10, 0x84, 0x10, 0x84, 0, 0, 0, 0 };
+	std::vector<unsigned char> placeholder;
+	for (int level = 0, levelSize = layerSize; ; level++, levelSize = std::max(1, levelSize / 2))
+	{
+		const size_t numBlocks = (size_t)((levelSize + 3) / 4) * ((levelSize + 3) / 4) * numLayers;
+		placeholder.resize(numBlocks * 8);
+		for (size_t block = 0; block < numBlocks; block++)
+			std::copy(greyBlock, greyBlock + 8, &placeholder[block * 8]);
+
+		glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, levelSize, levelSize, numLayers, 0,
+			(int)placeholder.size(), placeholder.data());
+		if (levelSize == 1)
+			break;
+	}
+}
+
+void TextureArray::destroy()
+{
+	glState.deleteTexture(textureID);
+	textureID = 0;
+	numLayers = 0;
+	size = 0;
+}
+
+void TextureArray::resample(const unsigned char* source, int sourceWidth, int sourceHeight,
+	unsigned char* destination, int destinationSize)
+{
+	for (int y = 0; y < destinationSize; y++)
+	{
+		// source rows under this row, at least one when enlarging
+		const int y0 = (int)((long long)y * sourceHeight / destinationSize);
+		const int y1 = std::max(y0 + 1, (int)((long long)(y + 1) * sourceHeight / destinationSize));
+
+		for (int x = 0; x < destinationSize; x++)
+		{
+			const int x0 = (int)((long long)x * sourceWidth / destinationSize);
+			const int x1 = std::max(x0 + 1, (int)((long long)(x + 1) * sourceWidth / destinationSize));
+
+			unsigned int sum[3] = { 0, 0, 0 };
+			for (int sy = y0; sy < y1; sy++)
+			{
+				const unsigned char* pixel = &source[((size_t)sy * sourceWidth + x0) * 3];
+				for (int sx = x0; sx < x1; sx++, pixel += 3)
+				{
+					sum[0] += pixel[0];
+					sum[1] += pixel[1];
+					sum[2] += pixel[2];
+				}
+			}
+
+			const unsigned int count = (unsigned int)((y1 - y0) * (x1 - x0));
+			unsigned char* out = &destination[((size_t)y * destinationSize + x) * 3];
+			for (int channel = 0; channel < 3; channel++)
+				out[channel] = (unsigned char)((sum[channel] + count / 2) / count);
+		}
+	}
+}
@@ -0,0 +1,386 @@
+// STL
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// file mapping
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <sys/stat.h>
+
+// Project
+#include "texturefile.h"
+#include "blockencoder.h"
+
+// unnamed namespace
+namespace
+{
+	const char MAGIC[4] = { 'M', 'I', 'P', 'S' };
+	const unsigned int VERSION = 3;
+}
+
+TextureFile::TextureFile()
+	: mapping(NULL), mappingSize(0)
+#ifdef _WIN32
+	, fileHandle(NULL), mappingHandle(NULL)
+#endif
+{
+	memset(&header, 0, sizeof(header));
+}
+
+TextureFile::~TextureFile()
+{
+	close();
+}
+
+bool TextureFile::open(const char* path, const char* sourcePath)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(Header))
+	{
+		close();
+		return false;
+	}
+	mappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle == NULL)
+	{
+		close();
+		return false;
+	}
+	mapping = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	mappingSize = (size_t)fileSize.QuadPart;
+#else
+	const int file = ::open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0 || fileInfo.st_size < (off_t)sizeof(Header))
+	{
+		::close(file);
+		return false;
+	}
+	mappingSize = (size_t)fileInfo.st_size;
+	void* view = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, file, 0);
+	::close(file);		// the mapping keeps the file open
+	mapping = view == MAP_FAILED ? NULL : (const unsigned char*)view;
+#endif
+	if (mapping == NULL)
+	{
+		close();
+		return false;
+	}
+
+	// the header is copied, the levels stay in the mapping
+	memcpy(&header, mapping, sizeof(Header));
+	if (!validHeader(header, sourcePath))
+	{
+		close();
+		return false;
+	}
+
+	int width = (int)header.width;
+	int height = (int)header.height;
+	for (unsigned int i = 0; i < header.numLevels; i++)
+	{
+		const unsigned long long offset = header.levelOffsets[i];
+		const unsigned long long size = header.levelSizes[i];
+		if (offset + size > mappingSize || size != levelSize((Format)header.format, width, height))
+		{
+			close();
+			return false;
+		}
+
+		Level level;
+		level.width = width;
+		level.height = height;
+		level.data = mapping + offset;
+		level.size = (size_t)size;
+		levels.push_back(level);
+
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return true;
+}
+
+void TextureFile::close()
+{
+	levels.clear();
+#ifdef _WIN32
+	if (mapping != NULL)
+		UnmapViewOfFile(mapping);
+	if (mappingHandle != NULL)
+		CloseHandle(mappingHandle);
+	if (fileHandle != NULL)
+		CloseHandle(fileHandle);
+	mappingHandle = NULL;
+	fileHandle = NULL;
+#else
+	if (mapping != NULL)
+		munmap((void*)mapping, mappingSize);
+#endif
+	mapping = NULL;
+	mappingSize = 0;
+}
+
+void TextureFile::prefault() const
+{
+	if (mapping == NULL)
+		return;
+
+#ifndef _WIN32
+	// starts the reads of pages that are not in the page cache all at once
+	madvise((void*)mapping, mappingSize, MADV_WILLNEED);
+#endif
+	// touching a byte of every page maps it in, the hint alone does not
+	const size_t pageSize = 4096;
+	volatile unsigned char sink = 0;
+	for (size_t offset = 0; offset < mappingSize; offset += pageSize)
+		sink += mapping[offset];
+	(void)sink;
+}
+
+bool TextureFile::write(const char* path, const char* sourcePath, unsigned long long sourceHash,
+	Format format, const std::vector<Level>& levels)
+{
+	if (levels.empty() || levels.size() > MAX_LEVELS)
+		return false;
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.format = format;
+	header.numLevels = (unsigned int)levels.size();
+	header.width = (unsigned int)levels[0].width;
+	header.height = (unsigned int)levels[0].height;
+	fileStamp(sourcePath, header.sourceSize, header.sourceTime);
+	header.sourceHash = sourceHash;
+
+	unsigned long long offset = sizeof(Header);
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		header.levelOffsets[i] = offset;
+		header.levelSizes[i] = levels[i].size;
+		offset += levels[i].size;
+	}
+
+	const std::string temporaryPath = std::string(path) + ".tmp";
+	FILE* file = fopen(temporaryPath.c_str(), "wb");
+	if (file == NULL)
+		return false;
+
+	bool written = fwrite(&header, sizeof(Header), 1, file) == 1;
+	for (size_t i = 0; written && i < levels.size(); i++)
+		written = fwrite(levels[i].data, 1, levels[i].size, file) == levels[i].size;
+	written = fclose(file) == 0 && written;
+
+#ifdef _WIN32
+	// rename does not replace an existing file on Windows
+	if (written)
+		remove(path);
+#endif
+	if (!written || rename(temporaryPath.c_str(), path) != 0)
+	{
+		remove(temporaryPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool TextureFile::readSourceHash(const char* path, const char* sourcePath, unsigned long long& hash)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+
+	Header header;
+	const bool read = fread(&header, sizeof(Header), 1, file) == 1;
+	fclose(file);
+	if (!read || !validHeader(header, sourcePath))
+		return false;
+
+	hash = header.sourceHash;
+	return true;
+}
+
+bool TextureFile::hashFile(const char* path, unsigned long long& hash)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+
+	// FNV-1a over 8 byte words in four lanes, so the multiplies overlap, folded
+	// together at the end. a short last word is zero padded
+	unsigned long long lanes[4] = { 14695981039346656037ull, 14695981039346656037ull, 14695981039346656037ull, 14695981039346656037ull };
+	unsigned long long length = 0;
+	unsigned long long buffer[8192];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		memset((unsigned char*)buffer + count, 0, (8 - count % 8) % 8);
+		const size_t words = (count + 7) / 8;
+		for (size_t i = 0; i < words; i++)
+		{
+			unsigned long long& lane = lanes[i % 4];
+			lane = (lane ^ buffer[i]) * 1099511628211ull;
+		}
+		length += count;
+	}
+	const bool failed = ferror(file) != 0;
+	fclose(file);
+	if (failed)
+		return false;
+
+	hash = length;
+	for (unsigned long long lane : lanes)
+		hash = (hash ^ lane) * 1099511628211ull;
+	return true;
+}
+
+size_t TextureFile::levelSize(Format format, int width, int height)
+{
+	if (blockCompressed(format))
+		return BlockEncoder::encodedSize(width, height);
+	return (size_t)width * height * channels(format);
+}
+
+int TextureFile::channels(Format format)
+{
+	switch (format)
+	{
+	case FORMAT_R8:
+	case FORMAT_RGTC1:
+		return 1;
+	case FORMAT_RGBA8:
+		return 4;
+	default:
+		return 3;
+	}
+}
+
+bool TextureFile::validHeader(const Header& header, const char* sourcePath)
+{
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+		header.format < FORMAT_RGB8 || header.format > FORMAT_RGBA8 || header.numLevels == 0 || header.numLevels > MAX_LEVELS)
+		return false;
+
+	// stale when the source has changed since the cache was written
+	unsigned long long sourceSize;
+	long long sourceTime;
+	return !fileStamp(sourcePath, sourceSize, sourceTime) ||
+		(sourceSize == header.sourceSize && sourceTime == header.sourceTime);
+}
+
+void TextureFile::buildMipmaps(const unsigned char* pixels, int width, int height, int channels,
+	std::vector<unsigned char>& storage, std::vector<Level>& levels)
+{
+	// sizes first, so storage is allocated once and the level pointers stay valid
+	std::vector<size_t> offsets;
+	size_t total = 0;
+	for (int levelWidth = width, levelHeight = height;; levelWidth = std::max(1, levelWidth / 2), levelHeight = std::max(1, levelHeight / 2))
+	{
+		offsets.push_back(total);
+		total += (size_t)levelWidth * levelHeight * channels;
+		if ((levelWidth == 1 && levelHeight == 1) || offsets.size() == MAX_LEVELS)
+			break;
+	}
+
+	storage.resize(total);
+	levels.clear();
+	memcpy(storage.data(), pixels, (size_t)width * height * channels);
+
+	Level level;
+	level.width = width;
+	level.height = height;
+	level.data = storage.data();
+	level.size = (size_t)width * height * channels;
+	levels.push_back(level);
+
+	for (size_t i = 1; i < offsets.size(); i++)
+	{
+		const Level& above = levels.back();
+		unsigned char* destination = storage.data() + offsets[i];
+
+		Level next;
+		next.width = std::max(1, above.width / 2);
+		next.height = std::max(1, above.height / 2);
+		next.data = destination;
+		next.size = (size_t)next.width * next.height * channels;
+
+		// a 2x2 box, narrowed to one row or column where the level above has only one.
+		// an odd last row or column of the level above is dropped, as GL does
+		const int stepX = above.width > 1 ? channels : 0;
+		const size_t stepY = above.height > 1 ? (size_t)above.width * channels : 0;
+		for (int y = 0; y < next.height; y++)
+		{
+			const unsigned char* row0 = above.data + (size_t)(y * 2) * above.width * channels;
+			const unsigned char* row1 = row0 + stepY;
+			for (int x = 0; x < next.width; x++)
+			{
+				const int x0 = x * 2 * channels;
+				const int x1 = x0 + stepX;
+				for (int channel = 0; channel < channels; channel++)
+				{
+					const unsigned int sum = row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel];
+					*destination++ = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+		levels.push_back(next);
+	}
+}
+
+std::string TextureFile::cachePath(const char* sourcePath, int size)
+{
+	if (size > 0)
+		return std::string(sourcePath) + "." + std::to_string(size) + ".mips";
+	return std::string(sourcePath) + ".mips";
+}
+
+bool TextureFile::fileStamp(const char* path, unsigned long long& size, long long& time)
+{
+	struct stat fileInfo;
+	if (stat(path, &fileInfo) != 0)
+	{
+		size = 0;
+		time = 0;
+		return false;
+	}
+	size = (unsigned long long)fileInfo.st_size;
+
+	// to the nanosecond where the file system keeps it, an edit in the same second
+	// as the last one still changes the stamp
+#if defined(_WIN32)
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+	{
+		// 100 ns since 1601, moved to 1970 first: scaled as it is it overflows
+		const unsigned long long ticks = ((unsigned long long)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+		time = (long long)(ticks - 116444736000000000ull) * 100;
+	}
+	else
+		time = (long long)fileInfo.st_mtime * 1000000000;
+#elif defined(__APPLE__)
+	time = (long long)fileInfo.st_mtimespec.tv_sec * 1000000000 + fileInfo.st_mtimespec.tv_nsec;
+#else
+	time = (long long)fileInfo.st_mtim.tv_sec * 1000000000 + fileInfo.st_mtim.tv_nsec;
+#endif
+	return true;
+}
@@ -0,0 +1,735 @@
+// STL
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+// GLAD header
+#include <glad/glad.h>
+
+// Project
+#include "textureloader.h"
+#include "texturearray.h"
+#include "glstate.h"
+#include "glextensions.h"
+
+// stb_image, implemented in scene.cpp
+#include "stb_image.h"
+
+TextureLoader::TextureLoader(unsigned int numThreads)
+	: pending(0), quit(false), compressionMode(COMPRESSION_OFF), uploadedBytes(0), streamBudget(DEFAULT_STREAM_BUDGET), memoryBudget(0), PBO(0)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < numThreads; i++)
+		workers.push_back(std::thread(&TextureLoader::workerLoop, this));
+}
+
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	jobCondition.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+void TextureLoader::setCompression(Compression compression)
+{
+	if (compression != COMPRESSION_OFF && !hasExtension("GL_EXT_texture_compression_s3tc"))
+	{
+		std::cout << "S3TC not supported, textures stay uncompressed" << std::endl;
+		compression = COMPRESSION_OFF;
+	}
+	compressionMode = compression;
+}
+
+unsigned int TextureLoader::load2D(const char* path)
+{
+	Job job;
+	job.start = Clock::now();
+
+	// an image loaded before shares its texture, found by path or else by content
+	const Texture* loaded = NULL;
+	for (const Texture& texture : textures)
+	{
+		if (texture.path == path)
+			loaded = &texture;
+	}
+	// only a hash kept in the image's cache is used here, reading the whole image
+	// would hold up the frame. a new image is hashed on the pool and matched from
+	// the next start, or from later loads once it has arrived
+	job.hashed = false;
+	if (loaded == NULL)
+	{
+		job.hashed = TextureFile::readSourceHash(TextureFile::cachePath(path, 0).c_str(), path, job.sourceHash);
+		for (const Texture& texture : textures)
+		{
+			if (job.hashed && texture.hashed && texture.sourceHash == job.sourceHash)
+				loaded = &texture;
+		}
+	}
+	if (loaded != NULL)
+	{
+		LoadStats entry = LoadStats();
+		entry.path = path;
+		entry.shared = true;
+		stats.push_back(entry);
+		return loaded->texture;
+	}
+
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	// wrapping and filtering come from the Sampler bound with it
+	glState.bindTexture(GL_TEXTURE_2D, texture);
+
+	// grey until the image arrives
+	const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+	job.path = path;
+	job.texture = texture;
+	job.layer = -1;
+	job.layerCount = 1;
+	job.layerSize = 0;
+	queue(job);
+
+	Texture entry;
+	entry.path = path;
+	entry.sourceHash = job.sourceHash;
+	entry.hashed = job.hashed;
+	entry.texture = texture;
+	entry.load = job.load;
+	textures.push_back(entry);
+	return texture;
+}
+
+void TextureLoader::loadLayer(const TextureArray& array, int layer, const char* path)
+{
+	Job job;
+	job.start = Clock::now();
+	job.path = path;
+	job.texture = array.texture();
+	job.layer = layer;
+	job.layerCount = array.layerCount();
+	job.layerSize = array.layerSize();
+	job.hashed = false;
+	queue(job);
+}
+
+void TextureLoader::queue(Job& job)
+{
+	job.compression = compressionMode;
+	job.load = stats.size();
+
+	LoadStats entry = LoadStats();
+	entry.path = job.path;
+	stats.push_back(entry);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(job);
+		pending++;
+	}
+	jobCondition.notify_one();
+}
+
+void TextureLoader::workerLoop()
+{
+	// the flip flag is per thread in stb_image
+	stbi_set_flip_vertically_on_load_thread(true);		// tell stb_image.h to flip loaded texture's on the y-axis.
+
+	for (;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobCondition.wait(lock, [this] { return quit || !jobs.empty(); });
+			if (quit)
+				return;
+			job = jobs.front();
+			jobs.pop_front();
+		}
+
+		Result result;
+		result.job = job;
+		result.cached = false;
+		const Clock::time_point start = Clock::now();
+		decode(job, result);
+		result.decodeTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			results.push_back(std::move(result));
+			pending--;
+		}
+		resultCondition.notify_all();
+	}
+}
+
+void TextureLoader::decode(const Job& job, Result& result)
+{
+	// a valid cache needs no decoding. it must be in the format the job would build
+	// from an image with its channels, and array layers must also have the right size
+	const std::string cachePath = TextureFile::cachePath(job.path, job.layerSize);
+	result.file = std::make_shared<TextureFile>();
+	if (result.file->open(cachePath.c_str(), job.path) &&
+		result.file->format() == chooseFormat(job, TextureFile::channels(result.file->format())) &&
+		(job.layer < 0 || (result.file->level(0).width == job.layerSize && result.file->level(0).height == job.layerSize)))
+	{
+		// the levels are only mapped so far, reading them in here keeps the page
+		// faults off the GL thread
+		result.file->prefault();
+		result.cached = true;
+		result.format = result.file->format();
+		for (int i = 0; i < result.file->levelCount(); i++)
+			result.levels.push_back(result.file->level(i));
+		return;
+	}
+	result.file.reset();
+
+	// the header tells the format, the image is then loaded with its channels
+	int width, height, nrChannels;
+	if (!stbi_info(job.path, &width, &height, &nrChannels))
+	{
+		std::cout << "Failed to load texture " << job.path << std::endl;
+		return;
+	}
+	const TextureFile::Format format = chooseFormat(job, nrChannels);
+	const int channels = TextureFile::channels(format);
+
+	unsigned char* data = stbi_load(job.path, &width, &height, &nrChannels, channels);
+	if (data == NULL)
+	{
+		std::cout << "Failed to load texture " << job.path << std::endl;
+		return;
+	}
+
+	if (job.layer < 0)
+	{
+		TextureFile::buildMipmaps(data, width, height, channels, result.pixels, result.levels);
+	}
+	else
+	{
+		std::vector<unsigned char> layer((size_t)job.layerSize * job.layerSize * 3);
+		TextureArray::resample(data, width, height, layer.data(), job.layerSize);
+		TextureFile::buildMipmaps(layer.data(), job.layerSize, job.layerSize, channels, result.pixels, result.levels);
+	}
+	stbi_image_free(data);
+
+	if (TextureFile::blockCompressed(format))
+		compress(result, format, job.compression == COMPRESSION_HIGH ? BlockEncoder::QUALITY_HIGH : BlockEncoder::QUALITY_FAST);
+	else
+		result.format = format;
+
+	// images without a cache yet are hashed here, off the GL thread
+	if (!result.job.hashed)
+	{
+		result.job.hashed = TextureFile::hashFile(job.path, result.job.sourceHash);
+		if (!result.job.hashed)
+			result.job.sourceHash = 0;
+	}
+
+	if (!TextureFile::write(cachePath.c_str(), job.path, result.job.sourceHash, result.format, result.levels))
+	{
+		std::cout << "Failed to write texture cache " << cachePath << std::endl;
+		return;
+	}
+
+	// dropped levels are streamed in again later. they are read from the cache
+	// then, the decoded copy is not kept around
+	std::shared_ptr<TextureFile> file = std::make_shared<TextureFile>();
+	if (file->open(cachePath.c_str(), job.path))
+	{
+		file->prefault();
+		result.file = file;
+		result.levels.clear();
+		for (int i = 0; i < file->levelCount(); i++)
+			result.levels.push_back(file->level(i));
+		std::vector<unsigned char>().swap(result.pixels);
+	}
+}
+
+void TextureLoader::compress(Result& result, TextureFile::Format format, BlockEncoder::Quality quality)
+{
+	size_t total = 0;
+	for (const TextureFile::Level& level : result.levels)
+		total += TextureFile::levelSize(format, level.width, level.height);
+
+	// the pool already encodes images side by side, each level stays on this worker
+	std::vector<unsigned char> blocks(total);
+	unsigned char* destination = blocks.data();
+	for (TextureFile::Level& level : result.levels)
+	{
+		if (format == TextureFile::FORMAT_BC1)
+			BlockEncoder::encodeBC1(level.data, level.width, level.height, destination, quality, 1);
+		else
+			BlockEncoder::encodeRGTC1(level.data, level.width, level.height, destination, 1);
+
+		level.data = destination;
+		level.size = TextureFile::levelSize(format, level.width, level.height);
+		destination += level.size;
+	}
+
+	result.pixels.swap(blocks);
+	result.format = format;
+}
+
+TextureFile::Format TextureLoader::chooseFormat(const Job& job, int channels)
+{
+	const bool compressed = job.compression != COMPRESSION_OFF;
+	if (job.layer >= 0 || channels == 3)
+		return compressed ? TextureFile::FORMAT_BC1 : TextureFile::FORMAT_RGB8;
+	if (channels == 1)
+		return compressed ? TextureFile::FORMAT_RGTC1 : TextureFile::FORMAT_R8;
+
+	// grey with alpha is loaded as RGBA
+	return TextureFile::FORMAT_RGBA8;
+}
+
+unsigned int TextureLoader::internalFormat(TextureFile::Format format)
+{
+	switch (format)
+	{
+	case TextureFile::FORMAT_R8:
+		return GL_R8;
+	case TextureFile::FORMAT_RGBA8:
+		return GL_RGBA8;
+	case TextureFile::FORMAT_BC1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case TextureFile::FORMAT_RGTC1:
+		return GL_COMPRESSED_RED_RGTC1;
+	default:
+		return GL_RGB8;
+	}
+}
+
+unsigned int TextureLoader::pixelFormat(TextureFile::Format format)
+{
+	switch (TextureFile::channels(format))
+	{
+	case 1:
+		return GL_RED;
+	case 4:
+		return GL_RGBA;
+	default:
+		return GL_RGB;
+	}
+}
+
+void TextureLoader::requireSize(unsigned int texture, float pixels)
+{
+	for (Residency& entry : residency)
+	{
+		if (entry.texture == texture)
+			entry.screenSize = std::max(entry.screenSize, pixels);
+	}
+}
+
+void TextureLoader::update()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.swap(results);
+	}
+	if (ready.empty() && images.empty())
+		return;
+
+	stream(streamBudget == 0 ? SIZE_MAX : streamBudget);
+}
+
+void TextureLoader::stream(size_t budget)
+{
+	// images that have just been decoded join the texture they belong to
+	const size_t firstNew = images.size();
+	for (Result& result : ready)
+	{
+		LoadStats& entry = stats[result.job.load];
+		entry.cached = result.cached;
+		entry.decodeTime = result.decodeTime;
+
+		// a 2D texture hashed on the pool can be matched by the loads after it
+		for (Texture& texture : textures)
+		{
+			if (texture.load == result.job.load && !texture.hashed && result.job.hashed)
+			{
+				texture.sourceHash = result.job.sourceHash;
+				texture.hashed = true;
+			}
+		}
+
+		// a failed image keeps its placeholder
+		if (result.levels.empty())
+			continue;
+
+		size_t index = 0;
+		while (index < residency.size() && residency[index].texture != result.job.texture)
+			index++;
+		if (index == residency.size())
+		{
+			const bool array = result.job.layer >= 0;
+			Residency texture;
+			texture.texture = result.job.texture;
+			texture.target = array ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+			texture.layerCount = array ? result.job.layerCount : 1;
+			texture.width = result.levels[0].width;
+			texture.height = result.levels[0].height;
+			// an array is allocated in full by TextureArray, a 2D texture not at all yet
+			texture.topLevel = array ? 0 : (int)result.levels.size();
+			texture.tailLevel = (int)result.levels.size() - 1;
+			while (texture.tailLevel > 0 && result.levels[texture.tailLevel - 1].width <= TAIL_SIZE &&
+				result.levels[texture.tailLevel - 1].height <= TAIL_SIZE)
+				texture.tailLevel--;
+			texture.baseLevel = 0;
+			// needs every level until it is first reported
+			texture.screenSize = FLT_MAX;
+			// fixed storage only while no level may have to be dropped
+			texture.immutable = !array && texStorage2D != NULL && memoryBudget == 0;
+			texture.format = result.format;
+			for (const TextureFile::Level& level : result.levels)
+				texture.levelSizes.push_back(level.size * texture.layerCount);
+			residency.push_back(texture);
+		}
+
+		Image image;
+		image.result = std::move(result);
+		image.residency = index;
+		image.nextLevel = (int)image.result.levels.size() - 1;
+		image.nextRow = 0;
+		images.push_back(std::move(image));
+	}
+	// unmaps the cache files of failed images
+	ready.clear();
+
+	fitBudget();
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// the new images show their small levels at once
+	for (size_t i = firstNew; i < images.size(); i++)
+	{
+		Image& image = images[i];
+		const Residency& texture = residency[image.residency];
+		const int last = (int)image.result.levels.size() - 1;
+		for (int level = last; level >= texture.tailLevel; level--)
+			upload(image.result, level, 0, rowCount(image.result.format, image.result.levels[level]));
+		image.nextLevel = texture.tailLevel - 1;
+		stats[image.result.job.load].firstLevelsTime = millisecondsSince(image.result.job);
+
+		if (texture.target == GL_TEXTURE_2D)
+		{
+			// the chain may stop short of 1x1 for huge images
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, last);
+
+			// one channel textures read as grey
+			if (TextureFile::channels(image.result.format) == 1)
+			{
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+			}
+		}
+	}
+
+	// the larger levels, oldest image first
+	size_t spent = 0;
+	for (Image& image : images)
+	{
+		const int topLevel = residency[image.residency].topLevel;
+		while (image.nextLevel >= topLevel && spent < budget)
+			spent += streamLevel(image, budget - spent);
+	}
+	for (const Image& image : images)
+	{
+		LoadStats& entry = stats[image.result.job.load];
+		if (entry.completeTime == 0.0 && image.nextLevel < residency[image.residency].topLevel)
+			entry.completeTime = millisecondsSince(image.result.job);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	// a 2D texture samples from its finest complete level. the layers of an array
+	// share one base level, the coarsest of theirs
+	for (size_t i = 0; i < residency.size(); i++)
+	{
+		Residency& texture = residency[i];
+		int baseLevel = texture.topLevel;
+		for (const Image& image : images)
+		{
+			if (image.residency == i)
+				baseLevel = std::max(baseLevel, image.nextLevel + 1);
+		}
+		if (baseLevel == texture.baseLevel)
+			continue;
+
+		glState.bindTexture(texture.target, texture.texture);
+		glTexParameteri(texture.target, GL_TEXTURE_BASE_LEVEL, baseLevel);
+		texture.baseLevel = baseLevel;
+	}
+}
+
+void TextureLoader::fitBudget()
+{
+	// every level is kept while they all fit
+	topLevels.assign(residency.size(), 0);
+	size_t total = 0;
+	for (const Residency& texture : residency)
+	{
+		for (size_t size : texture.levelSizes)
+			total += size;
+	}
+
+	// otherwise the finest level of the largest texture goes, first down to the
+	// level its size on screen needs, then down to its tail
+	for (int pass = 0; pass < 2 && memoryBudget != 0; pass++)
+	{
+		while (total > memoryBudget)
+		{
+			size_t largest = residency.size();
+			for (size_t i = 0; i < residency.size(); i++)
+			{
+				const int limit = residency[i].immutable ? 0 : pass == 0 ? neededLevel(residency[i]) : residency[i].tailLevel;
+				if (topLevels[i] < limit && (largest == residency.size() ||
+					residency[i].levelSizes[topLevels[i]] > residency[largest].levelSizes[topLevels[largest]]))
+					largest = i;
+			}
+			if (largest == residency.size())
+				break;
+
+			total -= residency[largest].levelSizes[topLevels[largest]];
+			topLevels[largest]++;
+		}
+	}
+
+	for (size_t i = 0; i < residency.size(); i++)
+	{
+		if (topLevels[i] != residency[i].topLevel)
+			setTopLevel(i, topLevels[i]);
+		residency[i].screenSize = 0.0f;
+	}
+}
+
+int TextureLoader::neededLevel(const Residency& texture)
+{
+	int level = 0;
+	while (level < texture.tailLevel &&
+		(float)std::max(texture.width >> (level + 1), texture.height >> (level + 1)) >= texture.screenSize)
+		level++;
+	return level;
+}
+
+void TextureLoader::setTopLevel(size_t index, int topLevel)
+{
+	Residency& texture = residency[index];
+	const GLenum format = internalFormat(texture.format);
+	const bool compressed = TextureFile::blockCompressed(texture.format);
+	glState.bindTexture(texture.target, texture.texture);
+
+	// immutable storage is allocated once, for the whole chain
+	if (texture.immutable)
+	{
+		texStorage2D(GL_TEXTURE_2D, (GLsizei)texture.levelSizes.size(), format, texture.width, texture.height);
+		texture.topLevel = topLevel;
+		return;
+	}
+
+	// dropped levels lie below the base level, redefining them empty frees them
+	for (int level = texture.topLevel; level < topLevel; level++)
+	{
+		if (texture.target == GL_TEXTURE_2D)
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, 0, 0, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		else
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGB8, 0, 0, 0, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	}
+
+	// added levels are allocated without data and streamed in
+	for (int level = topLevel; level < texture.topLevel; level++)
+	{
+		const int width = std::max(1, texture.width >> level);
+		const int height = std::max(1, texture.height >> level);
+		const int size = (int)texture.levelSizes[level];
+		if (texture.target == GL_TEXTURE_2D && !compressed)
+			glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, pixelFormat(texture.format), GL_UNSIGNED_BYTE, NULL);
+		else if (texture.target == GL_TEXTURE_2D)
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, size, NULL);
+		else if (!compressed)
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, width, height, texture.layerCount, 0, pixelFormat(texture.format), GL_UNSIGNED_BYTE, NULL);
+		else
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, width, height, texture.layerCount, 0, size, NULL);
+	}
+
+	// images that were streaming a dropped level, or had completed one, are done.
+	// one partway through topLevel - 1, the coarsest level dropped, starts its rows
+	// over too: the level was redefined empty
+	for (Image& image : images)
+	{
+		if (image.residency == index && image.nextLevel < topLevel)
+		{
+			image.nextLevel = topLevel - 1;
+			image.nextRow = 0;
+		}
+	}
+	texture.topLevel = topLevel;
+}
+
+size_t TextureLoader::streamLevel(Image& image, size_t budget)
+{
+	const TextureFile::Level& level = image.result.levels[image.nextLevel];
+	const int rows = rowCount(image.result.format, level);
+	const size_t size = rowSize(image.result.format, level);
+
+	// a level over the budget goes up in bands of rows
+	int count = rows - image.nextRow;
+	if ((size_t)count * size > budget)
+		count = std::max(1, (int)(budget / size));
+
+	upload(image.result, image.nextLevel, image.nextRow, count);
+
+	image.nextRow += count;
+	if (image.nextRow == rows)
+	{
+		image.nextLevel--;
+		image.nextRow = 0;
+	}
+	return (size_t)count * size;
+}
+
+void TextureLoader::upload(const Result& result, int levelIndex, int firstRow, int rows)
+{
+	const Clock::time_point start = Clock::now();
+	const TextureFile::Level& level = result.levels[levelIndex];
+	const bool compressed = TextureFile::blockCompressed(result.format);
+	const GLenum format = compressed ? internalFormat(result.format) : pixelFormat(result.format);
+	const bool array = result.job.layer >= 0;
+
+	// compressed rows are rows of 4x4 blocks
+	const int y = firstRow * (compressed ? 4 : 1);
+	const int height = std::min(rows * (compressed ? 4 : 1), level.height - y);
+	const size_t offset = (size_t)firstRow * rowSize(result.format, level);
+	const size_t size = std::min((size_t)rows * rowSize(result.format, level), level.size - offset);
+
+	const GLenum target = array ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+	glState.bindTexture(target, result.job.texture);
+
+	// rows of a mapped cache are read by GL straight from the mapping. decoded
+	// rows are copied once into the orphaned PBO and uploaded from there
+	const void* data = level.data + offset;
+	if (!result.file)
+	{
+		if (PBO == 0)
+			glGenBuffers(1, &PBO);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (mapped == NULL)
+		{
+			std::cout << "Failed to map pixel buffer for " << result.job.path << std::endl;
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return;
+		}
+		memcpy(mapped, data, size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		// with a PBO bound the data pointer is an offset into it
+		data = NULL;
+	}
+
+	if (!array && !compressed)
+		glTexSubImage2D(GL_TEXTURE_2D, levelIndex, 0, y, level.width, height, format, GL_UNSIGNED_BYTE, data);
+	else if (!array)
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, levelIndex, 0, y, level.width, height, format, (int)size, data);
+	else if (!compressed)
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, levelIndex, 0, y, result.job.layer, level.width, height, 1, format, GL_UNSIGNED_BYTE, data);
+	else
+		glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, levelIndex, 0, y, result.job.layer, level.width, height, 1, format, (int)size, data);
+	uploadedBytes += size;
+
+	if (!result.file)
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	LoadStats& entry = stats[result.job.load];
+	entry.uploadTime += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	entry.bytes += size;
+}
+
+int TextureLoader::rowCount(TextureFile::Format format, const TextureFile::Level& level)
+{
+	return TextureFile::blockCompressed(format) ? (level.height + 3) / 4 : level.height;
+}
+
+size_t TextureLoader::rowSize(TextureFile::Format format, const TextureFile::Level& level)
+{
+	return TextureFile::levelSize(format, level.width, TextureFile::blockCompressed(format) ? 4 : 1);
+}
+
+double TextureLoader::millisecondsSince(const Job& job)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - job.start).count();
+}
+
+bool TextureLoader::idle()
+{
+	for (const Image& image : images)
+	{
+		if (image.nextLevel >= residency[image.residency].topLevel)
+			return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending == 0 && results.empty();
+}
+
+size_t TextureLoader::residentBytes() const
+{
+	size_t total = 0;
+	for (const Residency& texture : residency)
+	{
+		for (size_t level = (size_t)texture.topLevel; level < texture.levelSizes.size(); level++)
+			total += texture.levelSizes[level];
+	}
+	return total;
+}
+
+void TextureLoader::finish()
+{
+	for (;;)
+	{
+		bool done;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			resultCondition.wait(lock, [this] { return pending == 0 || !results.empty(); });
+			done = pending == 0 && results.empty();
+			ready.swap(results);
+		}
+
+		// no budget, the caller is waiting for all of it
+		stream(SIZE_MAX);
+		if (done)
+			return;
+	}
+}
+
+void TextureLoader::destroy()
+{
+	// queued images are dropped, those being decoded waited for, so nothing
+	// arrives for a deleted texture
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		pending -= (unsigned int)jobs.size();
+		jobs.clear();
+		resultCondition.wait(lock, [this] { return pending == 0; });
+		results.clear();
+	}
+
+	images.clear();
+	residency.clear();
+	for (const Texture& texture : textures)
+		glState.deleteTexture(texture.texture);
+	textures.clear();
+	glDeleteBuffers(1, &PBO);
+	PBO = 0;
+}
@@ -0,0 +1,29 @@
+// GLAD header
+#include <glad/glad.h>	
+
+// Project
+#include "uniformbuffer.h"
+#include "renderstats.h"
+
+UniformBuffer::UniformBuffer(unsigned int binding, size_t size)
+	: size(size)
+{
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+
+	// stays bound to the binding point for the lifetime of the buffer
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+}
+
+void UniformBuffer::update(const void* data)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+	renderStats.uniformBufferUpdates++;
+}
+
+void UniformBuffer::deleteBuffer()
+{
+	glDeleteBuffers(1, &UBO);
+}
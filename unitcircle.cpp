@@ -0,0 +1,119 @@
+// STL
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Project
+#include "unitcircle.h"
+
+// unnamed namespace
+namespace
+{
+	constexpr double PI = 3.14159265358979323846;
+
+	// sine evaluated with a Taylor series so tables can be built at compile time
+	constexpr double constexprSin(double x)
+	{
+		// reduce to [-pi/2, pi/2] where the series converges quickly
+		while (x > PI)
+			x -= 2.0 * PI;
+		while (x < -PI)
+			x += 2.0 * PI;
+		if (x > PI / 2.0)
+			x = PI - x;
+		if (x < -PI / 2.0)
+			x = -PI - x;
+
+		double term = x;
+		double sum = x;
+		for (int n = 1; n < 10; n++)
+		{
+			term *= -x * x / double((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	constexpr double constexprCos(double x)
+	{
+		return constexprSin(x + PI / 2.0);
+	}
+
+	// table for a slice count known at compile time
+	template <int N>
+	struct StaticTable
+	{
+		float sines[N + 1];
+		float cosines[N + 1];
+
+		constexpr StaticTable() : sines{}, cosines{}
+		{
+			for (int i = 0; i <= N; i++)
+			{
+				sines[i] = (float)constexprSin(2.0 * PI * i / N);
+				cosines[i] = (float)constexprCos(2.0 * PI * i / N);
+			}
+		}
+	};
+
+	// slice counts common enough to bake into the executable
+	constexpr StaticTable<16> table16;
+	constexpr StaticTable<32> table32;
+	constexpr StaticTable<50> table50;
+	constexpr StaticTable<64> table64;
+	constexpr StaticTable<100> table100;
+	constexpr StaticTable<128> table128;
+
+	// table for any other slice count, built at run time
+	struct DynamicTable
+	{
+		std::vector<float> sines;
+		std::vector<float> cosines;
+		UnitCircle circle;
+	};
+
+	struct Cache
+	{
+		std::mutex mutex;
+		std::unordered_map<int, UnitCircle> circles;
+		std::vector<std::unique_ptr<DynamicTable>> dynamicTables;
+
+		Cache()
+		{
+			circles[16] = UnitCircle{ 16, table16.sines, table16.cosines };
+			circles[32] = UnitCircle{ 32, table32.sines, table32.cosines };
+			circles[50] = UnitCircle{ 50, table50.sines, table50.cosines };
+			circles[64] = UnitCircle{ 64, table64.sines, table64.cosines };
+			circles[100] = UnitCircle{ 100, table100.sines, table100.cosines };
+			circles[128] = UnitCircle{ 128, table128.sines, table128.cosines };
+		}
+	};
+}
+
+const UnitCircle& UnitCircle::get(int numSlices)
+{
+	static Cache cache;
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	auto found = cache.circles.find(numSlices);
+	if (found != cache.circles.end())
+		return found->second;
+
+	// compute the new table once, outside of any mesh
+	std::unique_ptr<DynamicTable> table(new DynamicTable());
+	table->sines.resize(numSlices + 1);
+	table->cosines.resize(numSlices + 1);
+	const double sliceAngleStep = 2.0 * PI / double(numSlices);
+	for (int i = 0; i <= numSlices; i++)
+	{
+		table->sines[i] = (float)sin(i * sliceAngleStep);
+		table->cosines[i] = (float)cos(i * sliceAngleStep);
+	}
+
+	UnitCircle& circle = cache.circles[numSlices];
+	circle = UnitCircle{ numSlices, table->sines.data(), table->cosines.data() };
+	cache.dynamicTables.push_back(std::move(table));
+	return circle;
+}